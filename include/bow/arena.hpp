@@ -0,0 +1,61 @@
+// arena.hpp: Arena de memoria (bump allocator por bloques).
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bow {
+
+// Tamaño del primer bloque; cada bloque nuevo duplica al anterior hasta kArenaMaxBlockBytes,
+// así un documento corto paga una sola reserva pequeña y uno largo pocas reservas grandes.
+inline constexpr std::size_t kArenaFirstBlockBytes = 4 * 1024;
+inline constexpr std::size_t kArenaMaxBlockBytes = 1024 * 1024;
+
+// Reservar es avanzar un puntero dentro del bloque actual; nada se libera por separado y todo
+// se suelta junto al destruir la arena. No es segura entre hilos: cada arena tiene un solo
+// dueño a la vez (los tokens de un documento o las palabras de una SymbolTable).
+class Arena {
+ public:
+  explicit Arena(std::size_t first_block_bytes = kArenaFirstBlockBytes);
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+    std::size_t padding = padding_for(alignment);
+    if (bytes + padding > static_cast<std::size_t>(limit_ - cursor_)) {
+      add_block(bytes + alignment);
+      padding = padding_for(alignment);
+    }
+    void* result = cursor_ + padding;
+    cursor_ += padding + bytes;
+    return result;
+  }
+
+  // Copia los bytes de `text` a la arena; la vista regresada vive lo mismo que la arena.
+  std::string_view store(std::string_view text) {
+    char* copy = static_cast<char*>(allocate(text.size(), 1));
+    std::char_traits<char>::copy(copy, text.data(), text.size());
+    return {copy, text.size()};
+  }
+
+  // Bytes pedidos al sistema (suma de los bloques).
+  std::size_t reserved_bytes() const { return reserved_bytes_; }
+
+ private:
+  std::size_t padding_for(std::size_t alignment) const {
+    return (alignment - reinterpret_cast<std::uintptr_t>(cursor_) % alignment) % alignment;
+  }
+  void add_block(std::size_t min_bytes);
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* cursor_ = nullptr;
+  char* limit_ = nullptr;
+  std::size_t next_block_bytes_;
+  std::size_t reserved_bytes_ = 0;
+};
+
+}  // namespace bow
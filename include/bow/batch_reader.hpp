@@ -0,0 +1,38 @@
+// batch_reader.hpp: Lectura por lotes de muchos documentos pequeños (io_uring o pread).
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bow {
+
+// Backend de lectura de documentos.
+enum class ReaderBackend {
+  kIfstream,  // read_file original, un documento a la vez.
+  kIoUring,   // Aperturas, statx, lecturas y cierres enviados por lotes a io_uring.
+  kPread,     // Respaldo sin io_uring: open + posix_fadvise de todo el lote, luego pread.
+};
+
+// Tamaño de lote por defecto para los backends por lotes.
+constexpr std::size_t kDefaultReadBatchSize = 64;
+
+// Función que carga un documento completo; cadena vacía si falla.
+using DocumentReader = std::function<std::string(const std::string&)>;
+
+// Carga un lote de documentos; el resultado tiene un contenido por ruta (vacío si falló).
+using BatchReader = std::function<std::vector<std::string>(const std::vector<std::string>&)>;
+
+// Traduce el nombre usado en la línea de comandos ("ifstream", "io_uring", "pread").
+// Regresa false si el nombre no corresponde a ningún backend.
+bool parse_reader_backend(const std::string& name, ReaderBackend& backend);
+
+// true si el kernel permite crear un anillo io_uring en este proceso.
+bool io_uring_available();
+
+// Construye el lector por lotes del backend pedido. kIfstream envuelve single_reader;
+// kIoUring cae a kPread si io_uring no está disponible.
+BatchReader make_batch_reader(ReaderBackend backend, DocumentReader single_reader);
+
+}  // namespace bow
@@ -0,0 +1,122 @@
+// core.hpp: Núcleo compartido (biblioteca bow_core) por las versiones serial y paralela:
+// lectura, tokenización, conteo y escritura del CSV tienen una sola implementación.
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bow/arena.hpp"
+#include "bow/experiment.hpp"
+#include "bow/metrics.hpp"
+#include "bow/symbol_table.hpp"
+#include "bow/thread_pool.hpp"
+#include "bow/tokenizer.hpp"
+#include "bow/word_counts.hpp"
+
+namespace bow {
+
+// Con el planificador de tareas, los documentos de al menos el doble de este tamaño se parten
+// en trozos que se cuentan como subtareas independientes (y que otros hilos pueden robar).
+inline constexpr std::size_t kTaskChunkBytes = 256 * 1024;
+
+// Lee un archivo completo y regresa su contenido como string (vacío si no se pudo abrir).
+std::string read_file(const std::string& path);
+
+// Normaliza a minúsculas y separa tokens con cualquier carácter que no sea alfanumérico ASCII
+// o '_' (mismo criterio que std::isalnum en el locale "C", pero con tabla de búsqueda); en
+// modo UTF-8 las letras multibyte también forman parte de los tokens (ver scan_characters). El
+// texto normalizado se escribe de una sola vez en `arena` y los tokens son vistas sobre él.
+// Las palabras vacías de options.stop_words no llegan a la lista.
+std::vector<std::string_view> tokenize_document(const std::string& content, Arena& arena,
+                                                const TokenizerOptions& options = {});
+
+// Criterio de tokenización de la configuración (--tokenizer y --stop-words).
+inline TokenizerOptions tokenizer_options(const ExperimentConfig& config) {
+  return {config.tokenizer, config.stop_words.get()};
+}
+
+// Qué se cuenta por token según la configuración (--stem, --ngrams y --char-ngrams).
+inline CountingOptions counting_options(const ExperimentConfig& config) {
+  return {config.stemmer, config.word_ngrams, config.char_ngrams};
+}
+
+// Cuenta cuántas veces aparece cada token dentro de un documento (en símbolos de `counter`).
+WordCounts count_tokens(const std::vector<std::string_view>& tokens, WordCounter& counter);
+
+// Escribe la matriz (filas en el orden de doc_names) en formato CSV.
+void write_csv(const std::vector<std::vector<int>>& matrix,
+               const std::vector<std::string>& vocabulary,
+               const std::vector<std::string>& doc_names,
+               const std::string& output_path);
+
+// Igual, con pesos TF-IDF (--tfidf).
+void write_csv(const std::vector<std::vector<float>>& matrix,
+               const std::vector<std::string>& vocabulary,
+               const std::vector<std::string>& doc_names,
+               const std::string& output_path);
+
+// Escritor incremental del mismo CSV que write_csv: el encabezado se escribe al abrirlo y las
+// filas se agregan una a una, así quien escribe no necesita tener la matriz completa.
+class CsvWriter {
+ public:
+  CsvWriter(const std::string& output_path, const std::vector<std::string>& vocabulary);
+  ~CsvWriter();  // Vuelca lo que quede en el buffer.
+
+  CsvWriter(const CsvWriter&) = delete;
+  CsvWriter& operator=(const CsvWriter&) = delete;
+
+  bool is_open() const { return output_.is_open(); }
+  void write_row(const std::string& doc_name, const int* values, std::size_t count);
+  // Los pesos se escriben con la representación más corta que regresa al mismo float.
+  void write_row(const std::string& doc_name, const float* values, std::size_t count);
+
+ private:
+  template <typename Value>
+  void append_row(const std::string& doc_name, const Value* values, std::size_t count);
+  void flush_if_full();
+
+  std::ofstream output_;
+  std::string buffer_;
+};
+
+// Cuenta los tokens de un solo documento (por bloques si config.stream_block_bytes > 0). Es
+// seguro llamarla desde varios hilos a la vez si cada uno usa su propio `counter`. Regresa
+// false si el documento está vacío o no se pudo leer.
+bool count_document(const std::string& path, const ExperimentConfig& config,
+                    WordCounter& counter, WordCounts& word_counts);
+
+// Conteos de los documentos que se pudieron procesar, en el orden recibido.
+struct DocumentCounts {
+  std::unique_ptr<SymbolTable> symbols;  // Palabras de todos los conteos (ids densos del rank).
+  std::vector<WordCounts> counts;
+  std::vector<std::size_t> positions;  // Posición de cada conteo dentro de la lista de rutas.
+  double io_read_ms = 0.0;             // Tiempo leyendo (ver DocumentPrefetcher).
+  double io_wait_ms = 0.0;             // Tiempo bloqueado esperando E/S.
+  SchedulerStats scheduler;            // Solo con conteo en hilos (tareas, robos, ocio).
+};
+
+// Lee, tokeniza y cuenta los documentos de `paths` respetando la configuración (modo por
+// bloques, prefetch y backend de lectura) y registrando cada fase en `recorder`. Los
+// documentos vacíos o ilegibles se omiten. Con config.num_threads > 1 el conteo se hace con
+// count_documents_in_tasks y se registra como una sola fase "conteo_en_hilos".
+DocumentCounts count_documents(const std::vector<std::string>& paths,
+                               const ExperimentConfig& config, PhaseRecorder& recorder);
+
+// Se invoca una vez por documento contado, en el hilo que terminó su conteo.
+using CountedCallback =
+    std::function<void(std::size_t position, const WordCounts& word_counts, int worker)>;
+
+// Cuenta los documentos con num_threads hilos y robo de trabajo: cada documento es una tarea
+// y los grandes (ver kTaskChunkBytes) generan una subtarea por trozo; el último trozo en
+// terminar une los conteos parciales. El resultado es idéntico al de count_documents, en el
+// mismo orden. Cada hilo lee con ifstream (no aplican prefetch ni --reader).
+DocumentCounts count_documents_in_tasks(const std::vector<std::string>& paths,
+                                        const ExperimentConfig& config, int num_threads,
+                                        const CountedCallback& on_counted = {});
+
+}  // namespace bow
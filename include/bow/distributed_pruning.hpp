@@ -0,0 +1,39 @@
+// distributed_pruning.hpp: Poda del vocabulario con frecuencias de documento globales (MPI).
+#pragma once
+
+#include <mpi.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "bow/large_count.hpp"
+#include "bow/pruning.hpp"
+#include "bow/trace.hpp"
+
+namespace bow {
+
+// Equivalente distribuido de prune_symbols (colectiva sobre `comm`); ningún rank junta el
+// vocabulario completo:
+// 1. Cada palabra local tiene un dueño, hash_word(palabra) % size. Cada rank manda a cada
+//    dueño sus palabras con su frecuencia de documento y sus apariciones locales
+//    (MPI_Alltoall de tamaños y dos MPI_Alltoallv).
+// 2. El dueño suma las estadísticas de cada palabra y aplica --min-df/--max-df con el número
+//    global de documentos (MPI_Allreduce).
+// 3. Con --max-features, si sobreviven más de K palabras en total, cada dueño aporta sus K
+//    mejores (total, palabra) con MPI_Allgatherv; todos eligen el mismo corte y cada dueño
+//    conserva las suyas que no quedan detrás de él.
+// 4. Un MPI_Alltoallv de regreso entrega a cada rank, en el orden en que mandó sus palabras,
+//    si se conservan.
+//
+// Regresa keep[símbolo] = 1 para los símbolos locales que sobreviven. Se llama antes de armar
+// el vocabulario local, así que las palabras podadas no viajan en ningún intercambio posterior.
+// Los tamaños son de 64 bits y los intercambios pasan por alltoallv_large/allgatherv_large con
+// `max_message` (--max-msg) elementos por mensaje, porque la poda es justo para vocabularios
+// enormes.
+std::vector<char> prune_symbols_distributed(const SymbolTable& symbols,
+                                            const std::vector<WordCounts>& counts,
+                                            const VocabularyPruning& pruning, MPI_Comm comm,
+                                            TraceRecorder& trace,
+                                            std::uint64_t max_message = kMaxMessageElements);
+
+}  // namespace bow
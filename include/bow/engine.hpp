@@ -0,0 +1,38 @@
+// engine.hpp: Motores de ejecución intercambiables, registrados por nombre.
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "bow/experiment.hpp"
+
+namespace bow {
+
+// Qué procesos deben invocar al motor.
+enum class EngineScope {
+  kRootOnly,  // Solo rank 0 (ej. serial); el resto de los ranks no participa.
+  kAllRanks,  // Colectivo: todos los ranks lo llaman tras una barrera (ej. MPI).
+};
+
+// Un motor recibe la misma configuración que los demás y regresa su resultado (en rank 0).
+struct Engine {
+  std::string name;         // Nombre para --engines.
+  std::string description;  // Texto corto para la ayuda.
+  EngineScope scope = EngineScope::kRootOnly;
+  std::function<ExperimentResult(const ExperimentConfig&)> run;
+};
+
+// Registra un motor; si ya existía uno con el mismo nombre lo reemplaza.
+void register_engine(Engine engine);
+
+// Busca un motor por nombre; nullptr si no está registrado.
+const Engine* find_engine(const std::string& name);
+
+// Motores registrados en orden de registro.
+const std::vector<Engine>& registered_engines();
+
+// Registra los motores incluidos en el proyecto. Se puede llamar más de una vez.
+void register_builtin_engines();
+
+}  // namespace bow
@@ -1,23 +1,65 @@
 // experiment.hpp: Define estructuras compartidas para configuración y resultados.
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "bow/batch_reader.hpp"
+#include "bow/metrics.hpp"
+#include "bow/ngrams.hpp"
+#include "bow/pruning.hpp"
+#include "bow/stemmer.hpp"
+#include "bow/tfidf.hpp"
+#include "bow/thread_pool.hpp"
+#include "bow/tokenizer.hpp"
+
 namespace bow {
 
+// Documentos por lote de --stream-gather cuando no se indica otro valor.
+inline constexpr std::size_t kDefaultGatherBatchDocuments = 64;
+
 // Configuración inmutable para cada experimento del proyecto.
 struct ExperimentConfig {
   int num_processes = 1;          // Número de procesos solicitados para MPI.
   std::string list_path;          // Ruta del archivo con nombres de libros.
   int num_experiments = 1;        // Corridas a promediar.
   std::vector<std::string> document_paths;  // Rutas completas a documentos por experimento.
+  bool collect_perf_counters = false;       // Lee contadores de hardware por fase (--perf).
+  std::string trace_path;                   // Chrome trace MPI (--trace); vacío = sin trace.
+  std::size_t stream_block_bytes = 0;       // > 0: lectura/conteo por bloques (--stream).
+  bool prefetch_documents = false;          // Lee el documento i+1 mientras se tokeniza i.
+  ReaderBackend reader_backend = ReaderBackend::kIfstream;  // --reader.
+  std::size_t read_batch_size = kDefaultReadBatchSize;      // Documentos por lote (--batch).
+  TokenizerMode tokenizer = TokenizerMode::kAscii;          // --tokenizer.
+  std::shared_ptr<const StopWords> stop_words;  // --stop-words; nullptr = sin filtro.
+  StemmerLanguage stemmer = StemmerLanguage::kNone;         // --stem.
+  NgramRange word_ngrams;                                   // --ngrams; {1, 1} = palabras.
+  NgramRange char_ngrams{0, 0};                             // --char-ngrams; {0, 0} = no.
+  VocabularyPruning pruning;  // --min-df, --max-df, --max-features.
+  TfidfOptions tfidf;         // --tfidf: pesos en vez de conteos.
+  bool shared_vocabulary = false;  // Una copia del vocabulario por nodo (--shared-vocab, MPI).
+  bool hierarchical_collectives = false;  // Reúne por nodo y luego entre nodos (--hierarchical).
+  bool nonblocking_collectives = false;  // MPI_Igatherv/MPI_Ibcast por bloques (--nonblocking).
+  std::uint64_t max_message_elements = std::numeric_limits<int>::max();  // --max-msg (MPI).
+  bool sample_sort_vocabulary = false;  // Orden distribuido del vocabulario (--sample-sort).
+  std::size_t gather_batch_documents = 0;  // > 0: filas a rank 0 por lotes (--stream-gather).
+  int num_threads = 0;  // --threads: hilos del motor "hilos" (0 = núcleos); > 1 también
+                        // reparte el conteo de serial y de cada rank MPI entre hilos.
 };
 
 // Resultado agregado que permitirá calcular métricas y speed-up.
 struct ExperimentResult {
   double total_time_ms = 0.0;     // Tiempo acumulado de todas las corridas.
   double average_time_ms = 0.0;   // Tiempo promedio calculado externamente.
+  std::vector<PhaseMetrics> phases;  // Por fase (en MPI: tiempo máximo y contadores sumados).
+  std::vector<std::uint64_t> peak_rss_bytes;  // Pico de RSS por rank (serial: un solo valor).
+  double io_read_ms = 0.0;        // Tiempo total leyendo documentos (suma de ranks en MPI).
+  double io_wait_ms = 0.0;        // Parte de esa lectura que bloqueó al cómputo.
+  SchedulerStats scheduler;       // Tareas, robos y ocio del planificador (suma de ranks).
 };
 
 }  // namespace bow
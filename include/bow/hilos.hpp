@@ -0,0 +1,12 @@
+// hilos.hpp: Versión paralela con hilos en un solo proceso (no requiere MPI).
+#pragma once
+
+#include "bow/experiment.hpp"
+
+namespace bow {
+
+// Ejecuta la bolsa de palabras repartiendo documentos entre config.num_threads hilos con robo
+// de trabajo. Escribe results/bow_threads.csv, idéntico a bow_serial.csv.
+ExperimentResult run_threaded(const ExperimentConfig& config);
+
+}  // namespace bow
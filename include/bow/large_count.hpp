@@ -0,0 +1,73 @@
+// large_count.hpp: Recolección y difusión MPI con conteos de 64 bits (más de 2^31 elementos).
+#pragma once
+
+#include <mpi.h>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace bow {
+
+// Elementos máximos por mensaje en las llamadas MPI clásicas (conteos y desplazamientos int).
+inline constexpr std::uint64_t kMaxMessageElements =
+    static_cast<std::uint64_t>(std::numeric_limits<int>::max());
+
+// Recolección no bloqueante en curso. Los arreglos de conteos viven aquí porque MPI los lee
+// hasta que la operación termina.
+struct PendingGather {
+  std::vector<MPI_Request> requests;
+  std::vector<int> counts;
+  std::vector<int> displs;
+#if MPI_VERSION >= 4
+  std::vector<MPI_Count> large_counts;
+  std::vector<MPI_Aint> large_displs;
+#endif
+
+  void wait();
+};
+
+// Equivalente a MPI_Gatherv hacia el rank 0 de `comm` con conteos de 64 bits. `counts` (uno
+// por rank, en elementos de `type`) debe ser el mismo en todos los ranks para que todos elijan
+// la misma estrategia:
+// - Si el total cabe en `max_message` se usa MPI_Gatherv normal.
+// - Si no, con MPI-4 se usa MPI_Gatherv_c (conteos MPI_Count, desplazamientos MPI_Aint).
+// - Sin MPI-4, o si se bajó `max_message` para forzarlo, cada rank envía su bloque en trozos
+//   de hasta `max_message` elementos punto a punto y rank 0 los recibe directo en su lugar.
+void gatherv_large(const void* send, MPI_Datatype type, void* recv,
+                   const std::vector<std::uint64_t>& counts, MPI_Comm comm,
+                   std::uint64_t max_message = kMaxMessageElements);
+
+// Versión no bloqueante (MPI_Igatherv / MPI_Igatherv_c / trozos con MPI_Isend/MPI_Irecv).
+PendingGather igatherv_large(const void* send, MPI_Datatype type, void* recv,
+                             const std::vector<std::uint64_t>& counts, MPI_Comm comm,
+                             std::uint64_t max_message = kMaxMessageElements);
+
+// MPI_Bcast desde rank 0 de `count` elementos (conocido en todos los ranks), en trozos de
+// hasta `max_message` elementos o con MPI_Bcast_c si hace falta y MPI-4 está disponible.
+void bcast_large(void* data, std::uint64_t count, MPI_Datatype type, MPI_Comm comm,
+                 std::uint64_t max_message = kMaxMessageElements);
+
+// Equivalente a MPI_Allgatherv sobre `comm` con conteos de 64 bits: cada rank aporta
+// counts[rank] elementos y todos reciben los bloques concatenados en orden de rank. `counts`
+// debe ser el mismo en todos los ranks; se elige la estrategia como en gatherv_large (trozos
+// punto a punto hacia cada rank si no hay MPI-4 o si se bajó `max_message`).
+void allgatherv_large(const void* send, MPI_Datatype type, void* recv,
+                      const std::vector<std::uint64_t>& counts, MPI_Comm comm,
+                      std::uint64_t max_message = kMaxMessageElements);
+
+// Equivalente a MPI_Alltoallv sobre `comm` con conteos de 64 bits y bloques contiguos en
+// orden de rank (los desplazamientos son las sumas prefijas de los conteos). Cada rank solo
+// conoce sus propios conteos, así que primero se acuerda con un MPI_Allreduce el mayor
+// volumen que envía o recibe algún rank y con él se elige la estrategia.
+void alltoallv_large(const void* send, const std::vector<std::uint64_t>& send_counts,
+                     void* recv, const std::vector<std::uint64_t>& recv_counts,
+                     MPI_Datatype type, MPI_Comm comm,
+                     std::uint64_t max_message = kMaxMessageElements);
+
+// MPI_Allreduce en sitio (MPI_IN_PLACE) de `count` elementos con conteos de 64 bits, con el
+// mismo criterio de trozos que bcast_large.
+void allreduce_large(void* data, std::uint64_t count, MPI_Datatype type, MPI_Op op,
+                     MPI_Comm comm, std::uint64_t max_message = kMaxMessageElements);
+
+}  // namespace bow
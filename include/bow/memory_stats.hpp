@@ -0,0 +1,24 @@
+// memory_stats.hpp: Contabilidad de memoria (asignaciones del heap y pico de RSS).
+#pragma once
+
+#include <cstdint>
+
+namespace bow {
+
+// Totales acumulados desde el arranque por los operadores new globales del proceso.
+struct AllocationStats {
+  std::uint64_t allocations = 0;  // Número de llamadas a operator new.
+  std::uint64_t bytes = 0;        // Bytes solicitados en total (no descuenta liberaciones).
+};
+
+// Lectura instantánea de los contadores globales de asignación (seguro entre hilos).
+AllocationStats allocation_snapshot();
+
+// Pico de memoria residente del proceso en bytes (VmHWM); 0 si no se puede leer.
+std::uint64_t peak_rss_bytes();
+
+// Reinicia el pico de RSS al valor actual para medir una corrida aislada (Linux >= 4.0).
+// Si el kernel no lo permite el pico sigue siendo el de toda la vida del proceso.
+void reset_peak_rss();
+
+}  // namespace bow
@@ -0,0 +1,72 @@
+// metrics.hpp: Registro de tiempos y contadores por fase del pipeline.
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "bow/memory_stats.hpp"
+#include "bow/perf_counters.hpp"
+#include "bow/thread_pool.hpp"
+#include "bow/trace.hpp"
+
+namespace bow {
+
+// Métricas acumuladas de una fase (puede abrirse y cerrarse varias veces, ej. por documento).
+struct PhaseMetrics {
+  std::string name;
+  double time_ms = 0.0;
+  HardwareCounters counters;
+  std::uint64_t allocations = 0;      // Llamadas a operator new durante la fase.
+  std::uint64_t allocated_bytes = 0;  // Bytes solicitados al heap durante la fase.
+};
+
+// Mide fases con begin/end. Las fases se declaran de antemano para que todos los ranks
+// compartan el mismo orden, aunque alguno no llegue a ejecutar cierta fase.
+class PhaseRecorder {
+ public:
+  PhaseRecorder(const std::vector<std::string>& phase_names, bool collect_counters);
+
+  // Refleja cada fase también como evento "fase" en la línea de tiempo (nullptr = sin trace).
+  void attach_trace(TraceRecorder* trace) { trace_ = trace; }
+
+  // Inicia la fase indicada (si no estaba declarada se agrega al final).
+  void begin(const std::string& phase);
+  // Cierra la fase abierta y acumula su duración y contadores.
+  void end();
+
+  const std::vector<PhaseMetrics>& phases() const { return phases_; }
+
+ private:
+  std::vector<PhaseMetrics> phases_;
+  std::unique_ptr<PerfCounterSet> counters_;  // nullptr si no se pidieron contadores.
+  TraceRecorder* trace_ = nullptr;
+  std::size_t current_ = 0;
+  bool open_ = false;
+  std::chrono::steady_clock::time_point start_;
+  HardwareCounters start_counters_;
+  AllocationStats start_allocations_;
+};
+
+// Suma las métricas de una corrida a un acumulado (mismo orden de fases).
+void accumulate_phases(std::vector<PhaseMetrics>& total, const std::vector<PhaseMetrics>& run);
+
+// Imprime una tabla con el promedio por corrida de cada fase.
+void print_phase_table(std::ostream& out, const std::string& title,
+                       const std::vector<PhaseMetrics>& total, int runs);
+
+// Imprime el pico de RSS (uno por rank en MPI, un solo valor en serial).
+void print_peak_rss(std::ostream& out, const std::string& title,
+                    const std::vector<std::uint64_t>& peak_by_rank);
+
+// Imprime el promedio por corrida de tareas, robos y tiempo ocioso del planificador.
+void print_scheduler_stats(std::ostream& out, const std::string& title,
+                           const SchedulerStats& total, int runs);
+
+// Conversión de bytes a MiB para reportes.
+double bytes_to_mib(std::uint64_t bytes);
+
+}  // namespace bow
@@ -0,0 +1,125 @@
+// ngrams.hpp: Rango de longitudes de n-gramas y extracción de n-gramas de caracteres.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bow {
+
+// Longitudes de n-grama a contar, ambas inclusivas (como ngram_range de scikit-learn). El
+// valor por defecto {1, 1} son solo las palabras sueltas.
+struct NgramRange {
+  std::size_t min = 1;
+  std::size_t max = 1;
+};
+
+// Traduce "n" (solo n-gramas de n) o "min,max". Regresa false si no son números, si
+// min > max, o si alguno queda fuera de [1, longest].
+bool parse_ngram_range(const std::string& text, std::size_t longest, NgramRange& range);
+
+// Los n-gramas de caracteres llegan hasta 8 caracteres.
+inline constexpr std::size_t kMaxCharNgramLength = 8;
+
+namespace detail {
+
+// base^0, base^1, ... (módulo 2^64).
+template <std::size_t Count>
+constexpr std::array<std::uint64_t, Count> powers_of(std::uint64_t base) {
+  std::array<std::uint64_t, Count> powers{};
+  powers[0] = 1;
+  for (std::size_t k = 1; k < Count; ++k) {
+    powers[k] = powers[k - 1] * base;
+  }
+  return powers;
+}
+
+}  // namespace detail
+
+// N-gramas de caracteres de cada token, como el analizador char_wb de scikit-learn: el token
+// se rodea de un espacio por lado (" casa ") y se emiten todas sus ventanas de min a max
+// caracteres; si el token rodeado no llega a n caracteres se emite completo una sola vez. Los
+// caracteres son code points (el tokenizador ya dejó el token en minúsculas y con UTF-8
+// válido).
+//
+// El hash de cada ventana sale de los hashes de prefijo del token (polinomial módulo 2^64),
+// así que se calcula una sola pasada por token y cada ventana cuesta O(1) sin importar n. Si
+// el token es ASCII (la verificación es una reducción que el compilador vectoriza) los
+// caracteres son los bytes y no hace falta ubicar sus inicios.
+class CharNgramExtractor {
+ public:
+  explicit CharNgramExtractor(NgramRange range) : range_(range) {}
+
+  // Llama on_ngram(texto, hash) por cada n-grama del token; el texto vive hasta la siguiente
+  // llamada. El hash solo depende del texto.
+  template <typename OnNgram>
+  void extract(std::string_view token, OnNgram&& on_ngram) {
+    padded_.assign(1, ' ');
+    padded_.append(token);
+    padded_.push_back(' ');
+    const std::size_t bytes = padded_.size();
+    prefix_.resize(bytes + 1);
+    prefix_[0] = 0;
+    unsigned char high_bits = 0;
+    for (std::size_t k = 0; k < bytes; ++k) {
+      const unsigned char byte = static_cast<unsigned char>(padded_[k]);
+      prefix_[k + 1] = prefix_[k] * kBase + byte;
+      high_bits |= byte;
+    }
+
+    const bool ascii = high_bits < 0x80;
+    std::size_t chars = bytes;
+    if (!ascii) {
+      starts_.clear();
+      for (std::size_t k = 0; k < bytes; ++k) {
+        if ((static_cast<unsigned char>(padded_[k]) & 0xC0) != 0x80) {
+          starts_.push_back(k);
+        }
+      }
+      chars = starts_.size();
+      starts_.push_back(bytes);
+    }
+    const auto start = [&](std::size_t c) { return ascii ? c : starts_[c]; };
+    const auto emit = [&](std::size_t first_char, std::size_t last_char) {
+      const std::size_t begin = start(first_char);
+      const std::size_t end = start(last_char);
+      const std::uint64_t hash = prefix_[end] - prefix_[begin] * kPowers[end - begin];
+      on_ngram(std::string_view(padded_).substr(begin, end - begin), finalize(hash));
+    };
+
+    for (std::size_t n = range_.min; n <= range_.max; ++n) {
+      if (chars <= n) {
+        emit(0, chars);  // Token corto: una sola vez, completo.
+        break;
+      }
+      for (std::size_t c = 0; c + n <= chars; ++c) {
+        emit(c, c + n);
+      }
+    }
+  }
+
+ private:
+  static constexpr std::uint64_t kBase = 0x100000001B3ULL;  // Impar: primo de FNV.
+  // Una ventana ocupa a lo más kMaxCharNgramLength caracteres de 4 bytes.
+  static constexpr std::size_t kMaxWindowBytes = 4 * kMaxCharNgramLength;
+
+  static constexpr std::array<std::uint64_t, kMaxWindowBytes + 1> kPowers =
+      detail::powers_of<kMaxWindowBytes + 1>(kBase);
+
+  // El hash polinomial reparte mal los bits bajos, que son los que indexan las tablas.
+  static std::uint64_t finalize(std::uint64_t hash) {
+    hash ^= hash >> 31;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    return hash ^ (hash >> 29);
+  }
+
+  NgramRange range_;
+  std::string padded_;
+  std::vector<std::uint64_t> prefix_;  // prefix_[k]: hash de los primeros k bytes.
+  std::vector<std::size_t> starts_;    // Inicio de cada carácter (solo tokens no ASCII).
+};
+
+}  // namespace bow
@@ -0,0 +1,50 @@
+// perf_counters.hpp: Contadores de hardware (perf_event_open) sin dependencias externas.
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace bow {
+
+// Valores de los contadores de hardware para una ventana de tiempo.
+struct HardwareCounters {
+  std::uint64_t cycles = 0;          // Ciclos de CPU (modo usuario).
+  std::uint64_t instructions = 0;    // Instrucciones retiradas.
+  std::uint64_t cache_misses = 0;    // Fallos del último nivel de caché.
+  std::uint64_t branch_misses = 0;   // Predicciones de salto erróneas.
+  std::uint64_t dtlb_misses = 0;     // Fallos de lectura en la dTLB.
+  bool available = false;            // false si el kernel/hardware no expone los eventos.
+
+  HardwareCounters& operator+=(const HardwareCounters& other);
+};
+
+// Diferencia entre dos lecturas (fin - inicio) de la misma ventana.
+HardwareCounters operator-(const HardwareCounters& end, const HardwareCounters& begin);
+
+// Instrucciones por ciclo; 0 cuando no hay ciclos registrados.
+double instructions_per_cycle(const HardwareCounters& counters);
+
+// Abre un contador por evento para el proceso actual y los deja corriendo hasta destruirse.
+// Cuentan también los hilos creados después de abrirlos, así que debe construirse antes de
+// lanzar los trabajadores cuyas fases se quieren medir.
+// En sistemas sin soporte (otro SO, contenedores, perf_event_paranoid alto) queda inactivo.
+class PerfCounterSet {
+ public:
+  PerfCounterSet();
+  ~PerfCounterSet();
+
+  PerfCounterSet(const PerfCounterSet&) = delete;
+  PerfCounterSet& operator=(const PerfCounterSet&) = delete;
+
+  // true si al menos el contador de ciclos se pudo abrir.
+  bool available() const;
+
+  // Lectura acumulada (escalada por multiplexación) desde que se abrieron los contadores.
+  HardwareCounters read() const;
+
+ private:
+  static constexpr int kNumEvents = 5;
+  std::array<int, kNumEvents> fds_;
+};
+
+}  // namespace bow
@@ -0,0 +1,58 @@
+// prefetch.hpp: Lectura anticipada del siguiente documento para traslapar E/S y tokenización.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "bow/batch_reader.hpp"
+
+namespace bow {
+
+// Entrega los documentos en orden, leyéndolos en lotes de batch_size. Con prefetch habilitado
+// usa doble buffer: mientras el consumidor procesa el lote actual, un hilo auxiliar ya está
+// leyendo el siguiente (con lotes de 1, el documento i+1 mientras se tokeniza el i).
+// Deshabilitado lee de forma síncrona en next(), así el bucle del consumidor es el mismo.
+class DocumentPrefetcher {
+ public:
+  DocumentPrefetcher(std::vector<std::string> paths, DocumentReader reader, bool enabled);
+  DocumentPrefetcher(std::vector<std::string> paths, BatchReader reader, std::size_t batch_size,
+                     bool enabled);
+  ~DocumentPrefetcher();
+
+  DocumentPrefetcher(const DocumentPrefetcher&) = delete;
+  DocumentPrefetcher& operator=(const DocumentPrefetcher&) = delete;
+
+  // Contenido del siguiente documento; espera si su lectura aún no termina.
+  std::string next();
+
+  // Tiempo total dedicado a leer (en el hilo auxiliar si hay prefetch).
+  double read_time_ms() const { return read_ms_; }
+  // Tiempo que el consumidor estuvo bloqueado esperando E/S.
+  double wait_time_ms() const { return wait_ms_; }
+
+ private:
+  // Lanza en segundo plano la lectura del lote que empieza en first.
+  void launch(std::size_t first);
+  // Lee de inmediato el lote que empieza en first y acumula su tiempo de lectura.
+  std::vector<std::string> read_batch(std::size_t first);
+
+  std::vector<std::string> paths_;
+  BatchReader reader_;
+  std::size_t batch_size_;
+  bool enabled_;
+  std::size_t next_batch_ = 0;              // Primer documento del siguiente lote por leer.
+  std::vector<std::string> current_;        // Lote que está consumiendo el llamador.
+  std::size_t current_pos_ = 0;
+  std::future<std::vector<std::string>> pending_;
+  double read_ms_ = 0.0;  // Solo lo escribe la tarea pendiente; se lee tras get().
+  double wait_ms_ = 0.0;
+};
+
+// Pide al kernel que empiece a leer el archivo en segundo plano (posix_fadvise WILLNEED).
+// Se usa en el modo por bloques, donde no hay un buffer completo que adelantar.
+void advise_will_need(const std::string& path);
+
+}  // namespace bow
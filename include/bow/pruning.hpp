@@ -0,0 +1,75 @@
+// pruning.hpp: Poda del vocabulario por frecuencia de documento y por número de columnas.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bow/symbol_table.hpp"
+#include "bow/word_counts.hpp"
+
+namespace bow {
+
+// Cota de frecuencia de documento como min_df/max_df de scikit-learn: un entero es un número
+// de documentos y un real en [0, 1] una proporción del corpus.
+struct DocumentFrequencyBound {
+  double value = 0.0;
+  bool proportion = false;
+
+  // Número de documentos que representa en un corpus de `documents`.
+  double resolve(std::uint64_t documents) const {
+    return proportion ? value * static_cast<double>(documents) : value;
+  }
+};
+
+// Poda pedida en la línea de comandos (--min-df, --max-df, --max-features). Se conservan los
+// términos con min_df <= df <= max_df y, de ellos, los max_features con más apariciones en
+// todo el corpus (empates por orden de palabra).
+struct VocabularyPruning {
+  DocumentFrequencyBound min_df{1.0, false};
+  DocumentFrequencyBound max_df{1.0, true};
+  std::size_t max_features = 0;  // 0 = sin límite.
+
+  bool enabled() const {
+    return min_df.proportion || min_df.value > 1.0 || !max_df.proportion ||
+           max_df.value < 1.0 || max_features > 0;
+  }
+
+  bool keeps_frequency(std::uint64_t document_frequency, std::uint64_t documents) const {
+    const double frequency = static_cast<double>(document_frequency);
+    return frequency >= min_df.resolve(documents) && frequency <= max_df.resolve(documents);
+  }
+};
+
+// Traduce "5" (documentos) o "0.5" (proporción, con punto decimal). Regresa false si no es un
+// número no negativo o si la proporción pasa de 1.
+bool parse_document_frequency(const std::string& text, DocumentFrequencyBound& bound);
+
+// Traduce el límite de columnas de --max-features. Regresa false si `text` no es un entero sin
+// signo (vacío, con signo o con otros caracteres) o si no cabe en size_t.
+bool parse_max_features(const std::string& text, std::size_t& max_features);
+
+// Frecuencia de documento y apariciones totales de cada símbolo en `counts`.
+struct TermStatistics {
+  std::vector<std::uint64_t> document_frequency;
+  std::vector<std::uint64_t> total;
+};
+
+TermStatistics term_statistics(const std::vector<WordCounts>& counts, std::size_t symbols);
+
+// true si (total, palabra) va antes que (other_total, other_word) al elegir max_features.
+inline bool ranks_before(std::uint64_t total, std::string_view word, std::uint64_t other_total,
+                         std::string_view other_word) {
+  return total != other_total ? total > other_total : word < other_word;
+}
+
+// Marca (1) los símbolos de `counts` que sobreviven a la poda en un solo proceso.
+std::vector<char> prune_symbols(const SymbolTable& symbols, const std::vector<WordCounts>& counts,
+                                const VocabularyPruning& pruning);
+
+// Quita de cada conteo los símbolos con keep[símbolo] == 0.
+void drop_pruned(std::vector<WordCounts>& counts, const std::vector<char>& keep);
+
+}  // namespace bow
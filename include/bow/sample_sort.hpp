@@ -0,0 +1,41 @@
+// sample_sort.hpp: Ordenamiento distribuido (sample sort) del vocabulario global con MPI.
+#pragma once
+
+#include <mpi.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bow/large_count.hpp"
+#include "bow/trace.hpp"
+
+namespace bow {
+
+// Parte del vocabulario global que le toca a un rank después del sample sort.
+struct SortedVocabularyRange {
+  std::string owned;                // Rango contiguo del vocabulario global, cada palabra con '\n'.
+  std::uint64_t owned_words = 0;
+  std::uint64_t first_column = 0;   // Columna global de la primera palabra de `owned`.
+  std::uint64_t total_words = 0;    // Tamaño del vocabulario global.
+  std::vector<std::uint64_t> local_columns;  // Columna global de cada palabra local, en orden.
+};
+
+// Ordena el vocabulario global sin juntarlo en un solo rank (colectiva sobre `comm`):
+// 1. Cada rank toma muestras regulares de su vocabulario, se reúnen en todos con
+//    MPI_Allgatherv y de ellas se eligen size - 1 separadores (iguales en todos los ranks).
+// 2. Cada rank parte su vocabulario con los separadores y lo redistribuye con MPI_Alltoallv:
+//    el rank b recibe las palabras entre el separador b - 1 y el b.
+// 3. Cada rank ordena y deduplica lo recibido; con MPI_Exscan obtiene su primera columna, así
+//    que los rangos de los ranks, en orden, forman el vocabulario global ordenado.
+// 4. Un segundo MPI_Alltoallv regresa a cada rank la columna global de cada palabra que envió.
+//
+// `local_serialized` son las palabras locales ordenadas, sin repetidos y terminadas en '\n'.
+// Los tamaños viajan como enteros de 64 bits y los intercambios pasan por allgatherv_large y
+// alltoallv_large, así un rank puede mandar más de 2^31 bytes de vocabulario a otro;
+// `max_message` (--max-msg) limita cada mensaje como en el resto de las colectivas.
+SortedVocabularyRange sample_sort_vocabulary(const std::string& local_serialized, MPI_Comm comm,
+                                             TraceRecorder& trace,
+                                             std::uint64_t max_message = kMaxMessageElements);
+
+}  // namespace bow
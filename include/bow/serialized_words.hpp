@@ -0,0 +1,30 @@
+// serialized_words.hpp: Utilidades de los intercambios MPI de palabras serializadas (sample
+// sort y poda distribuida).
+#pragma once
+
+#include <cstdint>
+#include <numeric>
+#include <string_view>
+#include <vector>
+
+namespace bow {
+
+// Inicio de cada palabra dentro de un texto de palabras terminadas en '\n'.
+inline std::vector<std::string_view> split_words(std::string_view text) {
+  std::vector<std::string_view> words;
+  std::size_t start = 0;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == '\n') {
+      words.push_back(text.substr(start, i - start));
+      start = i + 1;
+    }
+  }
+  return words;
+}
+
+// Total de elementos de un intercambio (tamaño del buffer de recepción).
+inline std::uint64_t total_of(const std::vector<std::uint64_t>& counts) {
+  return std::accumulate(counts.begin(), counts.end(), std::uint64_t{0});
+}
+
+}  // namespace bow
@@ -0,0 +1,58 @@
+// shared_vocab.hpp: Vocabulario global en memoria compartida, una copia por nodo (MPI-3).
+#pragma once
+
+#include <mpi.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "bow/topology.hpp"
+#include "bow/trace.hpp"
+
+namespace bow {
+
+// Vocabulario global de solo lectura compartido por los ranks de un mismo nodo. rank 0 lo
+// difunde solo entre los líderes de nodo; cada líder copia las palabras y construye el índice
+// de búsqueda (hash con direccionamiento abierto) en una ventana MPI_Win_allocate_shared, y
+// los demás ranks del nodo leen esa misma memoria en lugar de guardar su propia copia.
+//
+// Construcción y destrucción son colectivas sobre MPI_COMM_WORLD; `topology` debe vivir más
+// que el vocabulario.
+class SharedVocabulary {
+ public:
+  // `serialized` solo se usa en rank 0: palabras ordenadas y terminadas en '\n'.
+  // `max_message` limita los elementos por llamada MPI (ver bcast_large).
+  SharedVocabulary(const std::string& serialized, const NodeTopology& topology,
+                   TraceRecorder& trace, std::uint64_t max_message);
+  ~SharedVocabulary();
+  SharedVocabulary(const SharedVocabulary&) = delete;
+  SharedVocabulary& operator=(const SharedVocabulary&) = delete;
+
+  int size() const { return static_cast<int>(header_->word_count); }
+
+  // Columna de la palabra o -1 si no está en el vocabulario.
+  int find(std::string_view word) const;
+
+  std::string_view word(int column) const;
+
+  // Bytes de la ventana del nodo (una sola copia, sin importar cuántos ranks la lean).
+  std::uint64_t node_bytes() const { return header_->total_bytes; }
+
+ private:
+  // Encabezado al inicio de la ventana; después van offsets, tabla hash y palabras.
+  struct Header {
+    std::uint64_t word_count;
+    std::uint64_t table_capacity;  // Potencia de 2, al menos el doble de palabras.
+    std::uint64_t text_bytes;
+    std::uint64_t total_bytes;
+  };
+
+  MPI_Win window_ = MPI_WIN_NULL;
+  const Header* header_ = nullptr;
+  const std::uint64_t* offsets_ = nullptr;  // word_count + 1 inicios dentro de text_.
+  const std::int32_t* table_ = nullptr;     // Columna o -1 en cada casilla.
+  const char* text_ = nullptr;
+};
+
+}  // namespace bow
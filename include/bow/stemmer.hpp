@@ -0,0 +1,26 @@
+// stemmer.hpp: Reducción de palabras a su raíz (Porter para inglés, Snowball para español).
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace bow {
+
+// Idioma del stemmer (--stem).
+enum class StemmerLanguage {
+  kNone,     // Las palabras se cuentan tal como salen del tokenizador.
+  kEnglish,  // Algoritmo de Porter (1980), con las dos variantes de su implementación de
+             // referencia (-bli -> -ble y -logi -> -log).
+  kSpanish,  // Stemmer de Snowball para español.
+};
+
+// Traduce el nombre usado en la línea de comandos ("en", "es").
+// Regresa false si el nombre no corresponde a ningún idioma.
+bool parse_stemmer_language(const std::string& name, StemmerLanguage& language);
+
+// Raíz de `word`, ya normalizada por el tokenizador (minúsculas). Las palabras que el
+// algoritmo no contempla (en inglés, las que tienen bytes no ASCII; en español, las que no son
+// UTF-8 válido) se regresan sin cambios.
+std::string stem_word(std::string_view word, StemmerLanguage language);
+
+}  // namespace bow
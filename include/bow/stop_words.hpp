@@ -0,0 +1,114 @@
+// stop_words.hpp: Palabras vacías en una tabla hash perfecta consultada por el tokenizador.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bow/symbol_table.hpp"
+#include "bow/tokenizer.hpp"
+
+namespace bow {
+
+// Conjunto fijo de palabras vacías con hash perfecto (hash and displace): cada palabra ocupa
+// una casilla propia, así que consultar un token cuesta un hash y a lo más una comparación.
+// Antes del hash se consulta un mapa de bits de 4 KiB por (longitud, primer y último byte),
+// que descarta casi todas las palabras con contenido. El hash no recorre el token byte a byte
+// como hash_word: las palabras vacías son cortas y dos lecturas de hasta 8 bytes lo cubren.
+class StopWords {
+ public:
+  // `words` ya normalizadas como las deja el tokenizador; se ignoran vacías y duplicadas.
+  explicit StopWords(std::vector<std::string> words);
+
+  bool contains(std::string_view token) const {
+    if (token.empty() || !may_contain(token)) {
+      return false;
+    }
+    const std::uint64_t hash = key_of(token);
+    return slots_[slot_of(hash, displacements_[hash & bucket_mask_])] == token;
+  }
+
+  std::size_t size() const { return size_; }
+
+ private:
+  // Hash en tiempo constante hasta 16 bytes: la longitud más los primeros y últimos 8 bytes
+  // (4 si es más corto; tres bytes sueltos por debajo de 4), que juntos cubren todo el token.
+  // Los tokens más largos usan hash_word.
+  static std::uint64_t key_of(std::string_view token) {
+    const char* const data = token.data();
+    const std::size_t size = token.size();
+    std::uint64_t head = 0;
+    std::uint64_t tail = 0;
+    if (size > 16) {
+      return hash_word(token);
+    }
+    if (size >= 8) {
+      std::memcpy(&head, data, 8);
+      std::memcpy(&tail, data + size - 8, 8);
+    } else if (size >= 4) {
+      std::uint32_t first = 0;
+      std::uint32_t last = 0;
+      std::memcpy(&first, data, 4);
+      std::memcpy(&last, data + size - 4, 4);
+      head = first;
+      tail = last;
+    } else if (size > 0) {
+      head = static_cast<unsigned char>(data[0]) |
+             static_cast<unsigned>(static_cast<unsigned char>(data[size / 2])) << 8 |
+             static_cast<unsigned>(static_cast<unsigned char>(data[size - 1])) << 16;
+    }
+    return mix(head ^ mix(tail ^ (size * 0x9E3779B97F4A7C15ULL)));
+  }
+
+  // Finalizador de splitmix64: biyectivo y con buena avalancha en todos los bits.
+  static std::uint64_t mix(std::uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+  }
+
+  std::size_t slot_of(std::uint64_t hash, std::uint32_t displacement) const {
+    return static_cast<std::size_t>(mix(hash + displacement * 0x9E3779B97F4A7C15ULL)) &
+           slot_mask_;
+  }
+
+  // Bits del filtro: 16 longitudes (15 = de 15 o más) por 2048 combinaciones de bytes.
+  static constexpr std::size_t kFilterBits = 16 * 2048;
+
+  static std::size_t filter_bit(std::string_view token) {
+    const unsigned first = static_cast<unsigned char>(token.front());
+    const unsigned last = static_cast<unsigned char>(token.back());
+    return std::min<std::size_t>(token.size(), 15) * 2048 + ((first ^ (last << 3)) & 2047);
+  }
+
+  bool may_contain(std::string_view token) const {
+    const std::size_t bit = filter_bit(token);
+    return ((filter_[bit / 64] >> (bit % 64)) & 1) != 0;
+  }
+
+  bool place(const std::vector<std::string>& words);
+
+  std::vector<std::string> slots_;           // Palabra de cada casilla; vacía si está libre.
+  std::vector<std::uint32_t> displacements_;  // Uno por cubeta (bits bajos del hash).
+  std::uint64_t bucket_mask_ = 0;
+  std::uint64_t slot_mask_ = 0;
+  std::uint64_t filter_[kFilterBits / 64] = {};  // Ver may_contain.
+  std::size_t size_ = 0;
+};
+
+// Construye las palabras vacías de `sources`: "en" y "es" son las listas integradas (inglés y
+// español); cualquier otro valor es la ruta de un archivo con palabras separadas por espacios
+// o saltos de línea ('#' inicia un comentario). Cada palabra se normaliza con `mode`, y las
+// que no formarían un solo token con ese criterio (ej. "don't", o "está" en modo ascii) se
+// descartan. Regresa nullptr si algún archivo no se pudo abrir.
+std::shared_ptr<const StopWords> load_stop_words(const std::vector<std::string>& sources,
+                                                 TokenizerMode mode);
+
+}  // namespace bow
@@ -0,0 +1,37 @@
+// streaming.hpp: Lectura, tokenización y conteo fusionados en una sola pasada por bloques.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "bow/tokenizer.hpp"
+#include "bow/word_counts.hpp"
+
+namespace bow {
+
+// Tamaño de bloque por defecto para --stream sin valor explícito.
+constexpr std::size_t kDefaultStreamBlockBytes = 64 * 1024;
+
+// Lee el documento en bloques de block_size bytes y cuenta cada token en cuanto se completa,
+// arrastrando al siguiente bloque el token que quedó cortado en el borde. La memoria por
+// documento queda acotada por el bloque más el propio conteo. Misma normalización que
+// tokenize_document según `options` (un carácter UTF-8 cortado en el borde también se
+// arrastra, y las palabras vacías no se cuentan); el conteo queda en `word_counts`, en
+// símbolos de `counter`.
+// Regresa false si el archivo no se pudo abrir o está vacío (mismo criterio que read_file).
+bool stream_count_document(const std::string& path, std::size_t block_size,
+                           const TokenizerOptions& options, WordCounter& counter,
+                           WordCounts& word_counts);
+
+// Igual que stream_count_document pero solo para los tokens que empiezan dentro de
+// [begin, end): el token (o carácter UTF-8) cortado al inicio pertenece al trozo anterior y el
+// cortado al final se completa leyendo más allá de `end`. Así varios trozos de un documento
+// se cuentan por separado y la suma de sus conteos es la del documento completo. Con n-gramas,
+// los que empiezan en el trozo se completan con los tokens que siguen a `end`.
+// Regresa false si el archivo no se pudo abrir.
+bool stream_count_range(const std::string& path, std::uint64_t begin, std::uint64_t end,
+                        std::size_t block_size, const TokenizerOptions& options,
+                        WordCounter& counter, WordCounts& word_counts);
+
+}  // namespace bow
@@ -0,0 +1,141 @@
+// symbol_table.hpp: Tabla de símbolos por rank: cada palabra distinta recibe un id denso.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "bow/arena.hpp"
+
+namespace bow {
+
+using SymbolId = std::uint32_t;
+inline constexpr SymbolId kNoSymbol = UINT32_MAX;
+
+// Id de una palabra y su copia dentro de la arena de la tabla.
+struct Symbol {
+  SymbolId id = kNoSymbol;
+  std::string_view word;
+};
+
+// FNV-1a de 64 bits: suficiente para repartir palabras en una tabla y barato de calcular.
+inline std::uint64_t hash_word(std::string_view word) {
+  std::uint64_t hash = 1469598103934665603ULL;
+  for (unsigned char c : word) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Los n-gramas de palabras llegan hasta trigramas.
+inline constexpr std::size_t kMaxNgramLength = 3;
+
+// N-grama de palabras como tupla de símbolos; las posiciones que sobran quedan en kNoSymbol.
+using NgramKey = std::array<SymbolId, kMaxNgramLength>;
+
+// Hash rodante de la tupla: una multiplicación por símbolo y el mezclado final de splitmix64
+// para que los bits bajos (los que indexan la tabla) dependan de todos los símbolos.
+inline std::uint64_t hash_ngram(const NgramKey& key) {
+  std::uint64_t hash = 0;
+  for (const SymbolId part : key) {
+    hash = (hash ^ part) * 0x9E3779B97F4A7C15ULL;
+  }
+  hash ^= hash >> 31;
+  hash *= 0xBF58476D1CE4E5B9ULL;
+  return hash ^ (hash >> 29);
+}
+
+// Tabla de símbolos compartida por todos los hilos de un rank. Cada palabra distinta se
+// guarda una sola vez en la arena de la tabla y recibe el siguiente id (0, 1, 2, ...), así
+// los conteos por documento son enteros y las palabras solo se comparan al ordenar el
+// vocabulario. Las vistas que regresa word() viven lo mismo que la tabla.
+//
+// Los n-gramas de palabras (--ngrams) comparten los ids pero se guardan como tuplas de
+// símbolos: su texto ("a b c") solo se escribe con materialize_ngrams(), una vez por n-grama
+// distinto, cuando termina el conteo.
+//
+// intern() toma un candado; los hilos no la llaman por cada token sino a través de su propio
+// SymbolCache, que solo llega aquí la primera vez que ese hilo ve una palabra.
+class SymbolTable {
+ public:
+  SymbolTable();
+  SymbolTable(const SymbolTable&) = delete;
+  SymbolTable& operator=(const SymbolTable&) = delete;
+
+  // Símbolo de `word` (con su hash_word ya calculado), agregándola si es nueva.
+  Symbol intern(std::string_view word, std::uint64_t hash);
+
+  // Símbolo del n-grama `key` (con su hash_ngram ya calculado), agregándolo si es nuevo. Su
+  // word() queda vacía hasta materialize_ngrams().
+  SymbolId intern_ngram(const NgramKey& key, std::uint64_t hash);
+
+  // Escribe el texto de los n-gramas agregados desde la última llamada, con sus palabras
+  // separadas por un espacio. Sin candado: solo cuando ningún hilo está agregando.
+  void materialize_ngrams();
+
+  // Sin candado: solo cuando ningún hilo está agregando palabras.
+  std::string_view word(SymbolId id) const { return words_[id]; }
+  std::size_t size() const { return words_.size(); }
+
+  // Ordena `ids` según su palabra (orden lexicográfico de bytes, el de las columnas del CSV).
+  void sort_by_word(std::vector<SymbolId>& ids) const;
+
+ private:
+  void grow();
+  void grow_ngrams();
+
+  std::mutex mutex_;
+  Arena arena_;
+  std::vector<std::string_view> words_;
+  std::vector<std::uint64_t> hashes_;  // hash_word de cada palabra, para no recalcular al crecer.
+  std::vector<SymbolId> slots_;        // Direccionamiento abierto; kNoSymbol = casilla libre.
+  std::size_t num_words_ = 0;          // Símbolos en slots_ (los demás son n-gramas).
+
+  std::vector<NgramKey> ngram_keys_;
+  std::vector<SymbolId> ngram_ids_;            // Símbolo de cada ngram_keys_[i].
+  std::vector<std::uint64_t> ngram_hashes_;    // hash_ngram de cada ngram_keys_[i].
+  std::vector<std::uint32_t> ngram_slots_;     // Índice en ngram_keys_; kNoSymbol = libre.
+  std::size_t materialized_ngrams_ = 0;        // Los primeros ya tienen texto en words_.
+};
+
+// Caché de un solo hilo delante de la SymbolTable: la búsqueda por token no toma candados ni
+// compara contra palabras que este hilo nunca vio.
+class SymbolCache {
+ public:
+  explicit SymbolCache(SymbolTable& table);
+
+  SymbolId intern(std::string_view word) { return intern(word, hash_word(word)); }
+  // Con un hash propio (n-gramas de caracteres). Para una misma tabla, todas las llamadas
+  // deben usar la misma función de hash o una palabra podría quedar con dos ids.
+  SymbolId intern(std::string_view word, std::uint64_t hash);
+  SymbolId intern_ngram(const NgramKey& key);
+
+  SymbolTable& table() const { return *table_; }
+
+ private:
+  struct Entry {
+    Symbol symbol;  // La palabra apunta a la arena de la tabla.
+    std::uint64_t hash = 0;
+  };
+
+  struct NgramEntry {
+    NgramKey key{};
+    SymbolId id = kNoSymbol;
+    std::uint64_t hash = 0;
+  };
+
+  void grow();
+  void grow_ngrams();
+
+  SymbolTable* table_;
+  std::vector<Entry> entries_;
+  std::size_t used_ = 0;
+  std::vector<NgramEntry> ngram_entries_;  // Vacía hasta el primer n-grama.
+  std::size_t ngrams_used_ = 0;
+};
+
+}  // namespace bow
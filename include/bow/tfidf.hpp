@@ -0,0 +1,44 @@
+// tfidf.hpp: Ponderación TF-IDF de los conteos, con las fórmulas de TfidfTransformer.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bow/word_counts.hpp"
+
+namespace bow {
+
+// Salida TF-IDF (--tfidf). Como en scikit-learn, idf = ln((1 + n) / (1 + df)) + 1 con
+// smooth_idf e idf = ln(n / df) + 1 sin él; con sublinear_tf el conteo tf se reemplaza por
+// 1 + ln(tf). Cada fila se normaliza con norma l2.
+struct TfidfOptions {
+  bool enabled = false;
+  bool smooth_idf = true;
+  bool sublinear_tf = false;
+};
+
+// Traduce la lista opcional de --tfidf: "sublinear" y/o "nosmooth", separadas por comas.
+// Regresa false si alguna no se reconoce.
+bool parse_tfidf_options(const std::string& text, TfidfOptions& options);
+
+// Número de documentos de `counts` en que aparece cada columna (`column_of_symbol`, -1 para
+// símbolos sin columna). Es un arreglo por columna para poder sumarlo entre ranks tal cual.
+std::vector<std::uint64_t> column_document_frequency(const std::vector<WordCounts>& counts,
+                                                     const std::vector<int>& column_of_symbol,
+                                                     std::size_t columns);
+
+// idf de cada columna para un corpus de `documents` documentos.
+std::vector<double> inverse_document_frequency(
+    const std::vector<std::uint64_t>& document_frequency, std::uint64_t documents,
+    bool smooth_idf);
+
+// Escribe en `row` (denso, ya en ceros) los pesos del documento `counts`. La norma se suma en
+// orden de columna para que todos los motores escriban exactamente los mismos valores aunque
+// cada uno numere sus símbolos distinto. `scratch` se reutiliza entre filas.
+void weight_row(const WordCounts& counts, const std::vector<int>& column_of_symbol,
+                const std::vector<double>& idf, bool sublinear_tf, float* row,
+                std::vector<std::pair<int, double>>& scratch);
+
+}  // namespace bow
@@ -0,0 +1,93 @@
+// thread_pool.hpp: Planificador de tareas con robo de trabajo (deques estilo Chase–Lev).
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace bow {
+
+// Estadísticas de una o varias ejecuciones del planificador.
+struct SchedulerStats {
+  std::uint64_t tasks = 0;          // Tareas ejecutadas (documentos y trozos de documento).
+  std::uint64_t steals = 0;         // Tareas tomadas de la deque de otro trabajador.
+  std::uint64_t failed_steals = 0;  // Intentos de robo sobre deques vacías o perdidos por carrera.
+  double idle_ms = 0.0;             // Tiempo sumado de los trabajadores sin nada que ejecutar.
+
+  SchedulerStats& operator+=(const SchedulerStats& other);
+};
+
+// Número de hilos a usar: el pedido si es > 0, si no los núcleos disponibles (al menos 1).
+int resolve_thread_count(int requested);
+
+class TaskScheduler;
+
+// Una tarea recibe el planificador (para generar subtareas) y el trabajador que la ejecuta.
+using Task = std::function<void(TaskScheduler& scheduler, int worker)>;
+
+// Deque de Chase y Lev ("Dynamic Circular Work-Stealing Deque", con las barreras de Lê et al.
+// para modelos de memoria débiles). El dueño empuja y saca por abajo (LIFO, buena localidad);
+// los ladrones toman por arriba con un CAS sobre `top`. El arreglo circular crece al llenarse;
+// los arreglos viejos se conservan hasta destruir la deque porque un ladrón podría leerlos.
+class WorkStealingDeque {
+ public:
+  WorkStealingDeque();
+  ~WorkStealingDeque();
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  void push(Task* task);  // Solo el dueño.
+  Task* pop();            // Solo el dueño; nullptr si está vacía.
+  Task* steal();          // Cualquier hilo; nullptr si está vacía o perdió la carrera.
+
+ private:
+  struct Ring;
+  Ring* grow(Ring* ring, std::int64_t bottom, std::int64_t top);
+
+  alignas(64) std::atomic<std::int64_t> top_{0};
+  alignas(64) std::atomic<std::int64_t> bottom_{0};
+  std::atomic<Ring*> ring_;
+  std::vector<std::unique_ptr<Ring>> rings_;  // El actual y los retirados; solo los toca el dueño.
+};
+
+// Planificador de una sola corrida: se encolan las tareas iniciales con spawn(), run() lanza
+// los hilos y regresa cuando ya no queda ninguna tarea pendiente (incluidas las subtareas que
+// se generen durante la ejecución).
+class TaskScheduler {
+ public:
+  explicit TaskScheduler(int num_threads);
+  ~TaskScheduler();
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+  int num_threads() const { return static_cast<int>(deques_.size()); }
+
+  // Encola en la deque de `worker`. Dentro de una tarea debe ser el trabajador que la ejecuta;
+  // antes de run() puede ser cualquiera (así se hace el reparto inicial).
+  void spawn(int worker, Task task);
+
+  // Ejecuta con num_threads() hilos (el llamador es el trabajador 0) hasta vaciar las deques.
+  void run();
+
+  const SchedulerStats& stats() const { return stats_; }
+
+ private:
+  void work(int worker, SchedulerStats& stats);
+
+  std::vector<std::unique_ptr<WorkStealingDeque>> deques_;
+  std::atomic<std::int64_t> pending_{0};
+  SchedulerStats stats_;
+};
+
+// Ejecuta task(index, worker) para cada index en [0, count). Cada trabajador empieza con un
+// bloque contiguo de índices y, al vaciarlo, roba índices de los demás, así los documentos
+// grandes no dejan núcleos ociosos al final de la corrida. Si `stats` no es nulo se le suman
+// las estadísticas del planificador.
+void parallel_for_work_stealing(std::size_t count, int num_threads,
+                                const std::function<void(std::size_t index, int worker)>& task,
+                                SchedulerStats* stats = nullptr);
+
+}  // namespace bow
@@ -0,0 +1,139 @@
+// tokenizer.hpp: Criterio de tokenización (ASCII o UTF-8) compartido por todos los lectores.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace bow {
+
+// Modo del tokenizador (--tokenizer).
+enum class TokenizerMode {
+  kAscii,  // Alfanuméricos ASCII y '_'; cualquier byte >= 0x80 es delimitador.
+  kUtf8,   // Además, letras multibyte UTF-8 con plegado de mayúsculas de los alfabetos latinos.
+};
+
+class StopWords;
+
+// Criterio completo del tokenizador: el modo y, opcionalmente, las palabras vacías que se
+// descartan al cerrar cada token, antes de que lleguen al contador.
+struct TokenizerOptions {
+  TokenizerMode mode = TokenizerMode::kAscii;
+  const StopWords* stop_words = nullptr;  // nullptr: no se descarta nada.
+};
+
+// Traduce el nombre usado en la línea de comandos ("ascii", "utf8").
+// Regresa false si el nombre no corresponde a ningún modo.
+bool parse_tokenizer_mode(const std::string& name, TokenizerMode& mode);
+
+namespace detail {
+
+constexpr std::array<char, 256> make_token_table() {
+  std::array<char, 256> table{};
+  for (int c = '0'; c <= '9'; ++c) {
+    table[c] = static_cast<char>(c);
+  }
+  for (int c = 'a'; c <= 'z'; ++c) {
+    table[c] = static_cast<char>(c);
+    table[c - 'a' + 'A'] = static_cast<char>(c);
+  }
+  table['_'] = '_';
+  return table;
+}
+
+// true si los 16 bytes a partir de `data` son ASCII (ninguno tiene el bit alto).
+inline bool is_ascii16(const char* data) {
+#if defined(__SSE2__)
+  const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  return _mm_movemask_epi8(bytes) == 0;
+#else
+  std::uint64_t low = 0;
+  std::uint64_t high = 0;
+  std::memcpy(&low, data, sizeof(low));
+  std::memcpy(&high, data + sizeof(low), sizeof(high));
+  return ((low | high) & 0x8080808080808080ULL) == 0;
+#endif
+}
+
+// Decodifica el carácter multibyte que empieza en data[0] (un byte >= 0x80) y escribe en
+// `folded` su forma en minúsculas, nunca más larga que la original. Regresa los bytes que
+// ocupa, o 0 si la secuencia es válida pero está incompleta en los `available` bytes. Los
+// delimitadores y las secuencias inválidas (que consumen un solo byte) dejan folded_size en 0.
+std::size_t decode_multibyte(const unsigned char* data, std::size_t available, char* folded,
+                             std::size_t& folded_size);
+
+}  // namespace detail
+
+// Tabla byte -> carácter normalizado; 0 marca un delimitador. Equivale a tolower + isalnum en
+// el locale "C" (el programa nunca llama a setlocale) sin las dos llamadas por byte.
+inline constexpr std::array<char, 256> kTokenTable = detail::make_token_table();
+
+// Recorre [data, data + size) carácter por carácter con el criterio de `mode`. Para cada
+// carácter de token llama on_char(offset, bytes, n) con su forma normalizada, y para cada
+// delimitador on_delimiter(offset); offset es la posición donde empieza el carácter. Si un
+// callback regresa false el recorrido se detiene ahí.
+// Regresa los bytes consumidos: si es menos que size (y nadie se detuvo), lo que sobra es una
+// secuencia UTF-8 incompleta que el llamador vuelve a pasar junto con los bytes siguientes, o
+// trata como delimitador si ya no hay más.
+// En modo UTF-8 los tramos de 16 bytes ASCII se detectan con una sola comparación vectorial y
+// se recorren con la misma tabla que el modo ASCII; solo los bytes altos pasan por el
+// decodificador.
+template <typename OnChar, typename OnDelimiter>
+std::size_t scan_characters(const char* data, std::size_t size, TokenizerMode mode,
+                            OnChar&& on_char, OnDelimiter&& on_delimiter) {
+  const auto ascii_step = [&](std::size_t i) {
+    const char normalized = kTokenTable[static_cast<unsigned char>(data[i])];
+    return normalized != 0 ? on_char(i, &normalized, std::size_t{1}) : on_delimiter(i);
+  };
+
+  std::size_t i = 0;
+  if (mode == TokenizerMode::kAscii) {
+    for (; i < size; ++i) {
+      if (!ascii_step(i)) {
+        return i;
+      }
+    }
+    return i;
+  }
+
+  while (i < size) {
+    while (i + 16 <= size && detail::is_ascii16(data + i)) {
+      for (const std::size_t run_end = i + 16; i < run_end; ++i) {
+        if (!ascii_step(i)) {
+          return i;
+        }
+      }
+    }
+    const std::size_t run_end = std::min(size, i + 16);
+    for (; i < run_end; ++i) {
+      if (static_cast<unsigned char>(data[i]) < 0x80) {
+        if (!ascii_step(i)) {
+          return i;
+        }
+        continue;
+      }
+      char folded[4];
+      std::size_t folded_size = 0;
+      const std::size_t length =
+          detail::decode_multibyte(reinterpret_cast<const unsigned char*>(data + i), size - i,
+                                   folded, folded_size);
+      if (length == 0) {
+        return i;  // Secuencia incompleta: el llamador la completa con lo que siga.
+      }
+      if (!(folded_size != 0 ? on_char(i, folded, folded_size) : on_delimiter(i))) {
+        return i;
+      }
+      i += length - 1;
+    }
+  }
+  return i;
+}
+
+}  // namespace bow
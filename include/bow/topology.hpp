@@ -0,0 +1,33 @@
+// topology.hpp: Agrupación de ranks por nodo (memoria compartida) y comunicador de líderes.
+#pragma once
+
+#include <mpi.h>
+
+namespace bow {
+
+// Comunicadores de dos niveles: node_comm agrupa los ranks que comparten memoria y
+// leader_comm une al rank local 0 de cada nodo (MPI_COMM_NULL en los demás ranks). Las
+// claves conservan el orden de MPI_COMM_WORLD, así rank 0 es líder y rank 0 de leader_comm.
+//
+// Construcción y destrucción son colectivas sobre MPI_COMM_WORLD.
+class NodeTopology {
+ public:
+  NodeTopology();
+  ~NodeTopology();
+  NodeTopology(const NodeTopology&) = delete;
+  NodeTopology& operator=(const NodeTopology&) = delete;
+
+  MPI_Comm node_comm() const { return node_comm_; }
+  MPI_Comm leader_comm() const { return leader_comm_; }
+  int node_rank() const { return node_rank_; }
+  int node_size() const { return node_size_; }
+  bool is_leader() const { return node_rank_ == 0; }
+
+ private:
+  MPI_Comm node_comm_ = MPI_COMM_NULL;
+  MPI_Comm leader_comm_ = MPI_COMM_NULL;
+  int node_rank_ = 0;
+  int node_size_ = 1;
+};
+
+}  // namespace bow
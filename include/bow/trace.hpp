@@ -0,0 +1,62 @@
+// trace.hpp: Línea de tiempo por rank exportable como Chrome trace (chrome://tracing, Perfetto).
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace bow {
+
+// Intervalo [begin_us, end_us] en microsegundos del reloj monotónico del proceso.
+struct TraceEvent {
+  std::string name;
+  std::string category;  // "fase" para etapas del pipeline, "mpi" para llamadas MPI.
+  double begin_us = 0.0;
+  double end_us = 0.0;
+};
+
+// Registra eventos anidados (pila de begin/end). Si está deshabilitado no hace nada.
+class TraceRecorder {
+ public:
+  explicit TraceRecorder(bool enabled);
+
+  bool enabled() const { return enabled_; }
+
+  void begin(const std::string& name, const std::string& category);
+  void end();
+
+  const std::vector<TraceEvent>& events() const { return events_; }
+
+  // Tiempo actual del reloj monotónico en microsegundos.
+  static double now_us();
+
+ private:
+  bool enabled_;
+  std::vector<TraceEvent> events_;
+  std::vector<std::size_t> open_;  // Índices de eventos abiertos (para anidar).
+};
+
+// Abre un evento al construirse y lo cierra al destruirse (útil alrededor de llamadas MPI).
+class TraceScope {
+ public:
+  TraceScope(TraceRecorder& trace, const std::string& name, const std::string& category = "mpi");
+  ~TraceScope();
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  TraceRecorder& trace_;
+};
+
+// Escribe en formato Chrome trace JSON los eventos de cada rank (índice = rank), ya alineados
+// al reloj de rank 0 y con tiempos relativos a origin_us.
+void write_chrome_trace(const std::string& path,
+                        const std::vector<std::vector<TraceEvent>>& events_by_rank,
+                        double origin_us);
+
+// Colectiva sobre MPI_COMM_WORLD: estima el desfase de reloj de cada rank respecto a rank 0
+// (ping-pong, se conserva la muestra con menor latencia), reúne los eventos en rank 0 y escribe
+// el trace combinado en path. Todos los ranks deben llamarla.
+void write_merged_trace_mpi(const TraceRecorder& trace, const std::string& path);
+
+}  // namespace bow
@@ -0,0 +1,133 @@
+// word_counts.hpp: Conteo de palabras de un documento en el espacio de símbolos del rank.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bow/ngrams.hpp"
+#include "bow/stemmer.hpp"
+#include "bow/symbol_table.hpp"
+
+namespace bow {
+
+// Conteo de un documento: pares (símbolo, apariciones) ordenados por símbolo. Las palabras se
+// recuperan con la SymbolTable con la que se contó.
+using WordCounts = std::vector<std::pair<SymbolId, int>>;
+
+// Suma `other` a `counts` (ambos ordenados por símbolo).
+void merge_counts(WordCounts& counts, const WordCounts& other);
+
+// Qué cuenta un WordCounter en lugar de las palabras tal cual.
+struct CountingOptions {
+  StemmerLanguage stemmer = StemmerLanguage::kNone;  // Raíces (--stem).
+  NgramRange word_ngrams;                            // N-gramas de palabras (--ngrams).
+  NgramRange char_ngrams{0, 0};  // N-gramas de caracteres (--char-ngrams); {0, 0} = no.
+};
+
+// Contador de un solo hilo. Cada token se traduce a su símbolo con la caché del hilo y se
+// cuenta con un incremento en un arreglo indexado por símbolo; las palabras no se copian ni se
+// comparan por documento. Con stemming, cada palabra distinta se reduce a su raíz una sola vez
+// por hilo (la primera vez que aparece en algún documento) y finish() junta las palabras del
+// documento que comparten raíz; el recorrido por token no cambia.
+//
+// Con n-gramas (`ngrams.max` > 1) el contador guarda los símbolos (raíces, si hay stemming) de
+// los últimos tokens y cada n-grama se cuenta como un símbolo más, obtenido de la tupla con
+// SymbolCache::intern_ngram: por token no se concatena ni se copia texto. Los n-gramas no
+// cruzan documentos.
+//
+// Con n-gramas de caracteres cada token se reemplaza por sus n-gramas (CharNgramExtractor),
+// internados con el hash rodante del extractor; en ese modo no se cuentan palabras ni se
+// aplican --stem ni --ngrams.
+class WordCounter {
+ public:
+  explicit WordCounter(SymbolTable& table, const CountingOptions& options = {})
+      : cache_(table),
+        stemmer_(options.stemmer),
+        ngrams_(options.word_ngrams),
+        char_ngrams_(options.char_ngrams.max > 0),
+        chars_(options.char_ngrams) {}
+
+  void add(std::string_view token) {
+    if (char_ngrams_) {
+      add_char_ngrams(token);
+      return;
+    }
+    const SymbolId id = cache_.intern(token);
+    if (ngrams_.max > 1) {
+      add_to_ngrams(id, token, 0);
+    } else {
+      count(id, token);
+    }
+  }
+
+  // Token que sigue al final de un trozo (stream_count_range): solo completa los n-gramas
+  // que empezaron dentro del trozo, sin contarse él mismo.
+  void add_trailing(std::string_view token) {
+    add_to_ngrams(cache_.intern(token), token, ++trailing_);
+  }
+
+  // Tokens que hay que leer después del final de un trozo para completar sus n-gramas.
+  std::size_t trailing_tokens() const { return char_ngrams_ ? 0 : ngrams_.max - 1; }
+
+  // Regresa el conteo del documento en curso, ordenado por símbolo, y empieza uno nuevo.
+  WordCounts finish();
+
+  SymbolTable& table() const { return cache_.table(); }
+
+ private:
+  static constexpr std::uint32_t kAbsent = UINT32_MAX;
+
+  // Cuenta una aparición de `id`; regresa true si es la primera en el documento.
+  bool count_symbol(SymbolId id) {
+    if (id >= position_of_.size()) {
+      position_of_.resize(std::max<std::size_t>(id + 1, position_of_.size() * 2), kAbsent);
+    }
+    std::uint32_t& position = position_of_[id];
+    if (position == kAbsent) {
+      position = static_cast<std::uint32_t>(current_.size());
+      current_.emplace_back(id, 0);
+      ++current_[position].second;
+      return true;
+    }
+    ++current_[position].second;
+    return false;
+  }
+
+  // Cuenta la palabra `token` (símbolo `id`); su raíz se resuelve en finish().
+  void count(SymbolId id, std::string_view token) {
+    if (count_symbol(id) && stemmer_ != StemmerLanguage::kNone && !has_stem(id)) {
+      remember_stem(id, token);
+    }
+  }
+
+  bool has_stem(SymbolId id) const { return id < stem_of_.size() && stem_of_[id] != kNoSymbol; }
+
+  // Agrega el token a la ventana y cuenta los n-gramas que terminan en él. `trailing` es 0
+  // para tokens propios y k para el k-ésimo token después del final del trozo: de los
+  // n-gramas que terminan en él solo empiezan dentro del trozo los de más de k tokens.
+  void add_to_ngrams(SymbolId id, std::string_view token, std::size_t trailing);
+
+  void add_char_ngrams(std::string_view token);
+
+  // Calcula e interna la raíz de `token` (símbolo `id`). Se toma del token y no de la tabla
+  // porque otros hilos pueden estar internando al mismo tiempo.
+  void remember_stem(SymbolId id, std::string_view token);
+
+  SymbolCache cache_;
+  StemmerLanguage stemmer_;
+  NgramRange ngrams_;
+  NgramKey window_{};          // Últimos símbolos del documento, el más reciente al final.
+  std::size_t window_size_ = 0;
+  std::size_t trailing_ = 0;   // Tokens agregados con add_trailing en este documento.
+  bool char_ngrams_;
+  CharNgramExtractor chars_;
+  std::vector<std::uint32_t> position_of_;  // Símbolo -> posición en current_ (o kAbsent).
+  std::vector<SymbolId> stem_of_;           // Símbolo -> símbolo de su raíz (o kNoSymbol).
+  WordCounts current_;
+};
+
+}  // namespace bow
@@ -0,0 +1,78 @@
+#!/usr/bin/env bash
+# check_max_msg.sh: Ejercita los caminos en trozos de large_count_mpi.cpp con --max-msg chico.
+#
+# Con corpus pequeños ningún mensaje pasa de 2^31 elementos, así que las recolecciones,
+# difusiones e intercambios en trozos solo corren si se baja --max-msg. Para cada combinación
+# de opciones se genera una referencia con el motor serial sin límite y se compara byte a byte
+# con los CSV de serial, hilos y mpi corridos con --max-msg 1 y con un valor chico que no
+# divide a los tamaños.
+#
+# Uso: scripts/check_max_msg.sh [procesos] [lista]   (por defecto 3 y data/libros.txt)
+# Requiere el build con MPI (make) y mpirun en el PATH.
+set -u
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+APP="$ROOT/build/bow_app"
+NP="${1:-3}"
+LIST="$(realpath "${2:-$ROOT/data/libros.txt}")"
+MPIRUN=(mpirun -np "$NP")
+if [ "$(id -u)" = 0 ]; then
+  MPIRUN+=(--allow-run-as-root)
+fi
+MPIRUN+=(--oversubscribe)
+
+# Los CSV se escriben en results/ del directorio actual: se corre en uno temporal para no
+# pisar los resultados del proyecto.
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+OPTION_SETS=(
+  ""
+  "--tfidf"
+  "--sample-sort"
+  "--min-df 2 --max-features 2000"
+  "--nonblocking"
+  "--stream-gather 2"
+  "--sample-sort --nonblocking --tfidf sublinear"
+)
+MAX_MESSAGES=(1 97)
+
+failures=0
+for invalid in 0 -1 abc; do
+  if "$APP" 1 "$LIST" 1 --engines serial --max-msg "$invalid" >/dev/null 2>&1; then
+    echo "FALLA: --max-msg $invalid debería rechazarse"
+    failures=$((failures + 1))
+  fi
+done
+
+for options in "${OPTION_SETS[@]}"; do
+  rm -rf results
+  # shellcheck disable=SC2086  # Las opciones se separan a propósito.
+  if ! "$APP" 1 "$LIST" 1 --engines serial $options >/dev/null 2>&1; then
+    echo "FALLA: referencia serial con [$options]"
+    failures=$((failures + 1))
+    continue
+  fi
+  mv results/bow_serial.csv reference.csv
+  for max_message in "${MAX_MESSAGES[@]}"; do
+    rm -rf results
+    # shellcheck disable=SC2086
+    timeout 900 "${MPIRUN[@]}" "$APP" "$NP" "$LIST" 1 --engines serial,hilos,mpi \
+      --max-msg "$max_message" $options >run.log 2>&1
+    status=$?
+    for output in bow_serial.csv bow_threads.csv bow_mpi.csv; do
+      if [ "$status" -ne 0 ] || ! cmp -s "results/$output" reference.csv; then
+        echo "FALLA: $output con --max-msg $max_message [$options] (salida $status)"
+        failures=$((failures + 1))
+      fi
+    done
+    echo "ok: --max-msg $max_message [$options]"
+  done
+done
+
+if [ "$failures" -ne 0 ]; then
+  echo "$failures comparaciones fallaron"
+  exit 1
+fi
+echo "Todos los CSV coinciden con la referencia."
@@ -0,0 +1,19 @@
+// arena.cpp: Reserva de bloques de la arena.
+#include "bow/arena.hpp"
+
+#include <algorithm>
+
+namespace bow {
+
+Arena::Arena(std::size_t first_block_bytes) : next_block_bytes_(first_block_bytes) {}
+
+void Arena::add_block(std::size_t min_bytes) {
+  const std::size_t bytes = std::max(next_block_bytes_, min_bytes);
+  blocks_.push_back(std::unique_ptr<char[]>(new char[bytes]));  // Sin poner en cero.
+  cursor_ = blocks_.back().get();
+  limit_ = cursor_ + bytes;
+  reserved_bytes_ += bytes;
+  next_block_bytes_ = std::min(next_block_bytes_ * 2, kArenaMaxBlockBytes);
+}
+
+}  // namespace bow
@@ -0,0 +1,404 @@
+// batch_reader.cpp: Backends de lectura por lotes. io_uring se usa con las llamadas al sistema
+// directas (sin liburing) para no agregar dependencias externas.
+#include "bow/batch_reader.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define BOW_HAS_IO_URING 1
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+namespace {
+
+// Lote pread: primero se abren todos y se pide readahead al kernel, después se lee cada uno,
+// de modo que la E/S de los documentos siguientes avanza mientras se copia el actual.
+std::vector<std::string> read_batch_pread(const std::vector<std::string>& paths) {
+  std::vector<std::string> contents(paths.size());
+  std::vector<int> fds(paths.size(), -1);
+  std::vector<off_t> sizes(paths.size(), 0);
+
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    fds[i] = open(paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+    if (fds[i] < 0) {
+      std::cerr << "No se pudo abrir el archivo: " << paths[i] << std::endl;
+      continue;
+    }
+    struct stat info {};
+    if (fstat(fds[i], &info) == 0) {
+      sizes[i] = info.st_size;
+    }
+#if defined(POSIX_FADV_WILLNEED)
+    posix_fadvise(fds[i], 0, 0, POSIX_FADV_WILLNEED);
+#endif
+  }
+
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    if (fds[i] < 0) {
+      continue;
+    }
+    std::string& content = contents[i];
+    content.resize(static_cast<std::size_t>(sizes[i]));
+    std::size_t done = 0;
+    while (done < content.size()) {
+      const ssize_t bytes = pread(fds[i], &content[done], content.size() - done,
+                                  static_cast<off_t>(done));
+      if (bytes <= 0) {
+        break;
+      }
+      done += static_cast<std::size_t>(bytes);
+    }
+    content.resize(done);
+    close(fds[i]);
+  }
+  return contents;
+}
+
+#if defined(BOW_HAS_IO_URING)
+
+// Los índices de los anillos se comparten con el kernel: se publican con liberación y se leen
+// con adquisición, como pide la interfaz de io_uring.
+unsigned load_acquire(const unsigned* index) { return __atomic_load_n(index, __ATOMIC_ACQUIRE); }
+void store_release(unsigned* index, unsigned value) {
+  __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+// Anillo io_uring mínimo: solo lo necesario para enviar un lote y esperar todas sus respuestas.
+class IoUring {
+ public:
+  explicit IoUring(unsigned entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd_ < 0) {
+      return;
+    }
+
+    sq_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+    }
+
+    sq_ring_ = mmap(nullptr, sq_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                    IORING_OFF_SQ_RING);
+    cq_ring_ = single_mmap ? sq_ring_
+                           : mmap(nullptr, cq_bytes_, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+    sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd_, IORING_OFF_SQES);
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+      if (sqes != MAP_FAILED) {
+        munmap(sqes, sqes_bytes_);
+      }
+      release();
+      return;
+    }
+
+    char* sq = static_cast<char*>(sq_ring_);
+    char* cq = static_cast<char*>(cq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    entries_ = params.sq_entries;
+  }
+
+  ~IoUring() { release(); }
+
+  IoUring(const IoUring&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+
+  bool ok() const { return entries_ > 0; }
+  unsigned capacity() const { return entries_; }
+
+  // true si el kernel implementa todas las operaciones que usa el lector.
+  bool supports(std::initializer_list<unsigned> opcodes) const {
+    const std::size_t bytes = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+    std::unique_ptr<char[]> storage(new char[bytes]());
+    auto* probe = reinterpret_cast<io_uring_probe*>(storage.get());
+    if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, 256) < 0) {
+      return false;
+    }
+    for (unsigned opcode : opcodes) {
+      if (opcode > probe->last_op || (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Llena `count` SQEs con prepare(i, sqe), las envía en una sola llamada y entrega cada
+  // respuesta a on_complete(i, res). count no debe superar capacity().
+  template <typename Prepare, typename Complete>
+  bool submit_all(unsigned count, Prepare prepare, Complete on_complete) {
+    if (count == 0) {
+      return true;
+    }
+    unsigned tail = *sq_tail_;
+    for (unsigned i = 0; i < count; ++i) {
+      const unsigned slot = tail & sq_mask_;
+      io_uring_sqe* sqe = &sqes_[slot];
+      std::memset(sqe, 0, sizeof(*sqe));
+      prepare(i, sqe);
+      sqe->user_data = i;
+      sq_array_[slot] = slot;
+      ++tail;
+    }
+    store_release(sq_tail_, tail);
+
+    unsigned completed = 0;
+    unsigned to_submit = count;
+    while (completed < count) {
+      const long entered = syscall(__NR_io_uring_enter, fd_, to_submit, 1,
+                                   IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (entered < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      // Con SQEs pendientes, el valor es cuántas consumió el kernel en esta llamada.
+      to_submit -= std::min(to_submit, static_cast<unsigned>(entered));
+      unsigned head = *cq_head_;
+      const unsigned cq_tail = load_acquire(cq_tail_);
+      for (; head != cq_tail; ++head, ++completed) {
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        on_complete(static_cast<unsigned>(cqe.user_data), cqe.res);
+      }
+      store_release(cq_head_, head);
+    }
+    return true;
+  }
+
+ private:
+  void release() {
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_bytes_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_bytes_);
+    }
+    if (sq_ring_ != nullptr && sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_bytes_);
+    }
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+    sqes_ = nullptr;
+    sq_ring_ = cq_ring_ = nullptr;
+    fd_ = -1;
+    entries_ = 0;
+  }
+
+  int fd_ = -1;
+  unsigned entries_ = 0;
+  void* sq_ring_ = nullptr;
+  void* cq_ring_ = nullptr;
+  std::size_t sq_bytes_ = 0;
+  std::size_t cq_bytes_ = 0;
+  std::size_t sqes_bytes_ = 0;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  io_uring_sqe* sqes_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+};
+
+constexpr unsigned kRingEntries = 256;
+
+// Lector por lotes sobre io_uring. Cada bloque de documentos pasa por tres envíos:
+// openat + statx (dos SQEs por documento), read (repetido si hubo lecturas cortas) y close.
+class IoUringBatchReader {
+ public:
+  IoUringBatchReader() : ring_(kRingEntries) {}
+
+  bool ok() const {
+    return ring_.ok() &&
+           ring_.supports({IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE});
+  }
+
+  std::vector<std::string> read(const std::vector<std::string>& paths) {
+    std::vector<std::string> contents(paths.size());
+    const std::size_t chunk = ring_.capacity() / 2;  // openat + statx por documento.
+    for (std::size_t start = 0; start < paths.size(); start += chunk) {
+      const std::size_t count = std::min(chunk, paths.size() - start);
+      read_chunk(paths, start, count, contents);
+    }
+    return contents;
+  }
+
+ private:
+  void read_chunk(const std::vector<std::string>& paths, std::size_t start, std::size_t count,
+                  std::vector<std::string>& contents) {
+    std::vector<int> fds(count, -1);
+    std::vector<struct statx> stats(count);
+    std::vector<char> stat_ok(count, 0);
+
+    ring_.submit_all(
+        static_cast<unsigned>(2 * count),
+        [&](unsigned i, io_uring_sqe* sqe) {
+          const std::string& path = paths[start + i / 2];
+          sqe->fd = AT_FDCWD;
+          sqe->addr = reinterpret_cast<std::uintptr_t>(path.c_str());
+          if (i % 2 == 0) {
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+          } else {
+            sqe->opcode = IORING_OP_STATX;
+            sqe->len = STATX_SIZE;
+            sqe->off = reinterpret_cast<std::uintptr_t>(&stats[i / 2]);
+          }
+        },
+        [&](unsigned i, int res) {
+          if (i % 2 == 0) {
+            fds[i / 2] = res;
+          } else {
+            stat_ok[i / 2] = res == 0;
+          }
+        });
+
+    // Documentos que aún tienen bytes por leer, con su avance.
+    std::vector<std::size_t> pending;
+    std::vector<std::size_t> done(count, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+      if (fds[i] < 0) {
+        std::cerr << "No se pudo abrir el archivo: " << paths[start + i] << std::endl;
+        continue;
+      }
+      if (stat_ok[i] && stats[i].stx_size > 0) {
+        contents[start + i].resize(static_cast<std::size_t>(stats[i].stx_size));
+        pending.push_back(i);
+      }
+    }
+
+    while (!pending.empty()) {
+      std::vector<std::size_t> still_pending;
+      ring_.submit_all(
+          static_cast<unsigned>(pending.size()),
+          [&](unsigned k, io_uring_sqe* sqe) {
+            const std::size_t i = pending[k];
+            std::string& content = contents[start + i];
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = fds[i];
+            sqe->addr = reinterpret_cast<std::uintptr_t>(&content[done[i]]);
+            sqe->len = static_cast<unsigned>(
+                std::min<std::size_t>(content.size() - done[i], 1u << 30));
+            sqe->off = done[i];
+          },
+          [&](unsigned k, int res) {
+            const std::size_t i = pending[k];
+            if (res <= 0) {
+              contents[start + i].resize(done[i]);  // EOF anticipado o error: lo leído.
+              return;
+            }
+            done[i] += static_cast<std::size_t>(res);
+            if (done[i] < contents[start + i].size()) {
+              still_pending.push_back(i);  // Lectura corta: se reenvía el resto.
+            }
+          });
+      pending.swap(still_pending);
+    }
+
+    std::vector<int> open_fds;
+    for (int fd : fds) {
+      if (fd >= 0) {
+        open_fds.push_back(fd);
+      }
+    }
+    ring_.submit_all(
+        static_cast<unsigned>(open_fds.size()),
+        [&](unsigned k, io_uring_sqe* sqe) {
+          sqe->opcode = IORING_OP_CLOSE;
+          sqe->fd = open_fds[k];
+        },
+        [](unsigned, int) {});
+  }
+
+  IoUring ring_;
+};
+
+#endif
+
+}  // namespace
+
+namespace bow {
+
+bool parse_reader_backend(const std::string& name, ReaderBackend& backend) {
+  if (name == "ifstream") {
+    backend = ReaderBackend::kIfstream;
+  } else if (name == "io_uring") {
+    backend = ReaderBackend::kIoUring;
+  } else if (name == "pread") {
+    backend = ReaderBackend::kPread;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool io_uring_available() {
+#if defined(BOW_HAS_IO_URING)
+  static const bool available = IoUringBatchReader().ok();
+  return available;
+#else
+  return false;
+#endif
+}
+
+BatchReader make_batch_reader(ReaderBackend backend, DocumentReader single_reader) {
+  switch (backend) {
+    case ReaderBackend::kIoUring:
+#if defined(BOW_HAS_IO_URING)
+      if (io_uring_available()) {
+        auto reader = std::make_shared<IoUringBatchReader>();
+        return [reader](const std::vector<std::string>& paths) { return reader->read(paths); };
+      }
+#endif
+      {
+        static std::atomic<bool> warned{false};
+        if (!warned.exchange(true)) {
+          std::cerr << "Advertencia: io_uring no está disponible, se usa el lector pread."
+                    << std::endl;
+        }
+      }
+      return read_batch_pread;
+    case ReaderBackend::kPread:
+      return read_batch_pread;
+    case ReaderBackend::kIfstream:
+    default:
+      return [single_reader](const std::vector<std::string>& paths) {
+        std::vector<std::string> contents;
+        contents.reserve(paths.size());
+        for (const auto& path : paths) {
+          contents.push_back(single_reader(path));
+        }
+        return contents;
+      };
+  }
+}
+
+}  // namespace bow
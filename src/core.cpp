@@ -0,0 +1,346 @@
+// core.cpp: Implementación única de los kernels compartidos por serial y paralelo.
+#include "bow/core.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+#include "bow/prefetch.hpp"
+#include "bow/stop_words.hpp"
+#include "bow/streaming.hpp"
+
+namespace {
+
+// Tamaño del buffer de salida del CSV antes de volcarlo al archivo.
+constexpr std::size_t kCsvBufferBytes = 1 << 20;
+
+// Documento partido en trozos: cada subtarea llena su conteo parcial y la última en terminar
+// (remaining llega a cero) los une.
+struct ChunkedDocument {
+  std::vector<bow::WordCounts> partial;
+  std::atomic<std::size_t> remaining{0};
+  std::atomic<bool> failed{false};
+};
+
+}  // namespace
+
+namespace bow {
+
+std::string read_file(const std::string& path) {
+  std::ifstream input(path, std::ios::binary | std::ios::ate);
+  if (!input.is_open()) {
+    std::cerr << "No se pudo abrir el archivo: " << path << std::endl;
+    return {};
+  }
+
+  // Reservamos el tamaño exacto y leemos directo al string, sin el ostringstream intermedio.
+  const std::streamsize size = input.tellg();
+  std::string content(size > 0 ? static_cast<std::size_t>(size) : 0, '\0');
+  input.seekg(0);
+  input.read(content.data(), size);
+  content.resize(static_cast<std::size_t>(input.gcount()));
+  return content;
+}
+
+std::vector<std::string_view> tokenize_document(const std::string& content, Arena& arena,
+                                                const TokenizerOptions& options) {
+  std::vector<std::string_view> tokens;
+  tokens.reserve(content.size() / 6);  // Aproximación a la longitud media de palabra + separador.
+  // El texto normalizado nunca es más largo que el original: una sola reserva para todos los
+  // tokens, escritos uno tras otro.
+  char* const normalized_text = static_cast<char*>(arena.allocate(content.size(), 1));
+  char* token_begin = normalized_text;
+  char* out = normalized_text;
+
+  const auto close_token = [&] {
+    if (out == token_begin) {
+      return;
+    }
+    const std::string_view token(token_begin, static_cast<std::size_t>(out - token_begin));
+    if (options.stop_words != nullptr && options.stop_words->contains(token)) {
+      out = token_begin;  // Palabra vacía: su espacio lo reusa el siguiente token.
+      return;
+    }
+    tokens.push_back(token);
+    token_begin = out;
+  };
+  scan_characters(
+      content.data(), content.size(), options.mode,
+      [&](std::size_t, const char* bytes, std::size_t size) {
+        out = std::copy_n(bytes, size, out);
+        return true;
+      },
+      [&](std::size_t) {
+        close_token();
+        return true;
+      });
+  // Una secuencia UTF-8 incompleta al final del documento queda fuera, como un delimitador.
+  close_token();
+  return tokens;
+}
+
+WordCounts count_tokens(const std::vector<std::string_view>& tokens, WordCounter& counter) {
+  for (std::string_view token : tokens) {
+    counter.add(token);
+  }
+  return counter.finish();
+}
+
+CsvWriter::CsvWriter(const std::string& output_path, const std::vector<std::string>& vocabulary)
+    : output_(output_path, std::ios::binary) {
+  if (!output_.is_open()) {
+    std::cerr << "No se pudo abrir el CSV de salida: " << output_path << std::endl;
+    return;
+  }
+
+  // Armamos la salida en un buffer propio y convertimos enteros con to_chars: evita el
+  // formateo con locale de operator<< para cada celda de la matriz densa.
+  buffer_.reserve(kCsvBufferBytes + 64);
+  buffer_ += "document";
+  for (const auto& word : vocabulary) {
+    buffer_.push_back(',');
+    buffer_ += word;
+    flush_if_full();
+  }
+  buffer_.push_back('\n');
+}
+
+CsvWriter::~CsvWriter() {
+  if (output_.is_open()) {
+    output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  }
+}
+
+void CsvWriter::flush_if_full() {
+  if (buffer_.size() >= kCsvBufferBytes) {
+    output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+  }
+}
+
+template <typename Value>
+void CsvWriter::append_row(const std::string& doc_name, const Value* values, std::size_t count) {
+  if (!output_.is_open()) {
+    return;
+  }
+  char digits[32];
+  buffer_ += doc_name;
+  for (std::size_t i = 0; i < count; ++i) {
+    buffer_.push_back(',');
+    const auto converted = std::to_chars(digits, digits + sizeof(digits), values[i]);
+    buffer_.append(digits, converted.ptr);
+    flush_if_full();
+  }
+  buffer_.push_back('\n');
+}
+
+void CsvWriter::write_row(const std::string& doc_name, const int* values, std::size_t count) {
+  append_row(doc_name, values, count);
+}
+
+void CsvWriter::write_row(const std::string& doc_name, const float* values, std::size_t count) {
+  append_row(doc_name, values, count);
+}
+
+void write_csv(const std::vector<std::vector<int>>& matrix,
+               const std::vector<std::string>& vocabulary,
+               const std::vector<std::string>& doc_names,
+               const std::string& output_path) {
+  CsvWriter writer(output_path, vocabulary);
+  for (std::size_t i = 0; i < matrix.size(); ++i) {
+    writer.write_row(doc_names[i], matrix[i].data(), matrix[i].size());
+  }
+}
+
+void write_csv(const std::vector<std::vector<float>>& matrix,
+               const std::vector<std::string>& vocabulary,
+               const std::vector<std::string>& doc_names,
+               const std::string& output_path) {
+  CsvWriter writer(output_path, vocabulary);
+  for (std::size_t i = 0; i < matrix.size(); ++i) {
+    writer.write_row(doc_names[i], matrix[i].data(), matrix[i].size());
+  }
+}
+
+bool count_document(const std::string& path, const ExperimentConfig& config,
+                    WordCounter& counter, WordCounts& word_counts) {
+  if (config.stream_block_bytes > 0) {
+    return stream_count_document(path, config.stream_block_bytes, tokenizer_options(config),
+                                 counter, word_counts);
+  }
+  const std::string content = read_file(path);
+  if (content.empty()) {
+    return false;
+  }
+  Arena tokens_arena(content.size() + 64);  // Tokens del documento: se sueltan al contar.
+  word_counts =
+      count_tokens(tokenize_document(content, tokens_arena, tokenizer_options(config)), counter);
+  return true;
+}
+
+DocumentCounts count_documents_in_tasks(const std::vector<std::string>& paths,
+                                        const ExperimentConfig& config, int num_threads,
+                                        const CountedCallback& on_counted) {
+  const std::size_t num_documents = paths.size();
+  const std::size_t block_size =
+      config.stream_block_bytes > 0 ? config.stream_block_bytes : kDefaultStreamBlockBytes;
+  // Una tabla de símbolos para todos los hilos y un contador (con su caché) por hilo.
+  const int workers = std::max(1, std::min<int>(num_threads, static_cast<int>(num_documents)));
+  auto symbols = std::make_unique<SymbolTable>();
+  std::vector<WordCounter> counters;
+  counters.reserve(workers);
+  for (int w = 0; w < workers; ++w) {
+    counters.emplace_back(*symbols, counting_options(config));
+  }
+  // Cada tarea escribe solo en las casillas de su documento: no hace falta ningún candado.
+  std::vector<WordCounts> counts_by_position(num_documents);
+  std::vector<char> processed(num_documents, 0);
+  std::vector<std::unique_ptr<ChunkedDocument>> chunked(num_documents);
+
+  const auto finish = [&](std::size_t k, int worker) {
+    processed[k] = 1;
+    if (on_counted) {
+      on_counted(k, counts_by_position[k], worker);
+    }
+  };
+
+  const auto count_chunk = [&, block_size](std::size_t k, std::size_t chunk,
+                                           std::uint64_t size, int worker) {
+    ChunkedDocument& document = *chunked[k];
+    const std::uint64_t begin = chunk * kTaskChunkBytes;
+    const std::uint64_t end = std::min<std::uint64_t>(size, begin + kTaskChunkBytes);
+    if (!stream_count_range(paths[k], begin, end, block_size, tokenizer_options(config),
+                            counters[worker], document.partial[chunk])) {
+      document.failed.store(true, std::memory_order_relaxed);
+    }
+    if (document.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    if (document.failed.load(std::memory_order_relaxed)) {
+      return;
+    }
+    auto& counts = counts_by_position[k];
+    counts = std::move(document.partial.front());
+    for (std::size_t c = 1; c < document.partial.size(); ++c) {
+      merge_counts(counts, document.partial[c]);
+    }
+    document.partial.clear();
+    finish(k, worker);
+  };
+
+  const auto count_one = [&](std::size_t k, TaskScheduler& scheduler, int worker) {
+    std::error_code error;
+    const std::uint64_t size = std::filesystem::file_size(paths[k], error);
+    if (!error && size >= 2 * kTaskChunkBytes) {
+      const std::size_t chunks = (size + kTaskChunkBytes - 1) / kTaskChunkBytes;
+      chunked[k] = std::make_unique<ChunkedDocument>();
+      chunked[k]->partial.resize(chunks);
+      chunked[k]->remaining.store(chunks, std::memory_order_relaxed);
+      for (std::size_t c = 0; c < chunks; ++c) {
+        scheduler.spawn(worker, [&count_chunk, k, c, size](TaskScheduler&, int thief) {
+          count_chunk(k, c, size, thief);
+        });
+      }
+      return;
+    }
+    if (count_document(paths[k], config, counters[worker], counts_by_position[k])) {
+      finish(k, worker);
+    }
+  };
+
+  TaskScheduler scheduler(workers);
+  for (int w = 0; w < workers; ++w) {
+    // Bloque contiguo por trabajador, empujado al revés para que el dueño lo recorra en orden
+    // y los ladrones se lleven el final.
+    const std::size_t first = num_documents * w / workers;
+    const std::size_t last = num_documents * (w + 1) / workers;
+    for (std::size_t k = last; k > first; --k) {
+      scheduler.spawn(w, [&count_one, k](TaskScheduler& owner, int worker) {
+        count_one(k - 1, owner, worker);
+      });
+    }
+  }
+  scheduler.run();
+  symbols->materialize_ngrams();
+
+  DocumentCounts result;
+  result.symbols = std::move(symbols);
+  for (std::size_t k = 0; k < num_documents; ++k) {
+    if (processed[k] != 0) {
+      result.counts.push_back(std::move(counts_by_position[k]));
+      result.positions.push_back(k);
+    }
+  }
+  result.scheduler = scheduler.stats();
+  return result;
+}
+
+DocumentCounts count_documents(const std::vector<std::string>& paths,
+                               const ExperimentConfig& config, PhaseRecorder& recorder) {
+  if (config.num_threads > 1) {
+    recorder.begin("conteo_en_hilos");
+    DocumentCounts result = count_documents_in_tasks(paths, config, config.num_threads);
+    recorder.end();
+    return result;
+  }
+
+  DocumentCounts result;
+  result.symbols = std::make_unique<SymbolTable>();
+  WordCounter counter(*result.symbols, counting_options(config));
+  result.counts.reserve(paths.size());
+  result.positions.reserve(paths.size());
+
+  const bool streaming = config.stream_block_bytes > 0;
+  // Con el backend ifstream se lee documento por documento; los demás agrupan en lotes.
+  const std::size_t batch_size =
+      config.reader_backend == ReaderBackend::kIfstream ? 1 : config.read_batch_size;
+  DocumentPrefetcher prefetcher(paths, make_batch_reader(config.reader_backend, read_file),
+                                batch_size, config.prefetch_documents && !streaming);
+
+  for (std::size_t k = 0; k < paths.size(); ++k) {
+    if (streaming) {
+      if (config.prefetch_documents && k + 1 < paths.size()) {
+        advise_will_need(paths[k + 1]);
+      }
+      // Lectura, tokenización y conteo fusionados: nunca se guarda el documento completo.
+      recorder.begin("flujo_por_bloques");
+      WordCounts counts;
+      const bool processed =
+          stream_count_document(paths[k], config.stream_block_bytes, tokenizer_options(config),
+                                counter, counts);
+      recorder.end();
+      if (!processed) {
+        continue;
+      }
+      result.counts.push_back(std::move(counts));
+    } else {
+      recorder.begin("lectura");
+      const std::string content = prefetcher.next();
+      recorder.end();
+      if (content.empty()) {
+        continue;
+      }
+
+      recorder.begin("tokenizacion");
+      Arena tokens_arena(content.size() + 64);
+      const std::vector<std::string_view> tokens =
+          tokenize_document(content, tokens_arena, tokenizer_options(config));
+      recorder.begin("conteo");
+      result.counts.push_back(count_tokens(tokens, counter));
+      recorder.end();
+    }
+    result.positions.push_back(k);
+  }
+
+  result.symbols->materialize_ngrams();
+  result.io_read_ms = prefetcher.read_time_ms();
+  result.io_wait_ms = prefetcher.wait_time_ms();
+  return result;
+}
+
+}  // namespace bow
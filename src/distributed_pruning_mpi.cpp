@@ -0,0 +1,186 @@
+// distributed_pruning_mpi.cpp: Poda con estadísticas globales repartidas por hash de palabra.
+#include "bow/distributed_pruning.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <string_view>
+
+#include "bow/serialized_words.hpp"
+
+namespace bow {
+
+std::vector<char> prune_symbols_distributed(const SymbolTable& symbols,
+                                            const std::vector<WordCounts>& counts,
+                                            const VocabularyPruning& pruning, MPI_Comm comm,
+                                            TraceRecorder& trace, std::uint64_t max_message) {
+  int size = 1;
+  MPI_Comm_size(comm, &size);
+  const TermStatistics stats = term_statistics(counts, symbols.size());
+
+  // 1. Palabras locales agrupadas por dueño, con (df, total) intercalados.
+  std::vector<std::vector<SymbolId>> by_owner(size);
+  for (SymbolId id = 0; id < symbols.size(); ++id) {
+    if (stats.document_frequency[id] > 0) {
+      by_owner[hash_word(symbols.word(id)) % static_cast<std::uint64_t>(size)].push_back(id);
+    }
+  }
+  std::vector<SymbolId> sent;
+  std::string send_text;
+  std::vector<std::uint64_t> send_stats;
+  std::vector<std::uint64_t> send_bytes(size, 0);
+  std::vector<std::uint64_t> send_words(size, 0);
+  for (int owner = 0; owner < size; ++owner) {
+    const std::size_t before = send_text.size();
+    for (SymbolId id : by_owner[owner]) {
+      sent.push_back(id);
+      send_text += symbols.word(id);
+      send_text.push_back('\n');
+      send_stats.push_back(stats.document_frequency[id]);
+      send_stats.push_back(stats.total[id]);
+    }
+    send_bytes[owner] = send_text.size() - before;
+    send_words[owner] = by_owner[owner].size();
+  }
+  by_owner.clear();
+
+  std::vector<std::uint64_t> recv_bytes(size, 0);
+  std::vector<std::uint64_t> recv_words(size, 0);
+  std::uint64_t documents = counts.size();
+  {
+    TraceScope scope(trace, "MPI_Alltoall tamaños poda");
+    MPI_Alltoall(send_bytes.data(), 1, MPI_UINT64_T, recv_bytes.data(), 1, MPI_UINT64_T, comm);
+    MPI_Alltoall(send_words.data(), 1, MPI_UINT64_T, recv_words.data(), 1, MPI_UINT64_T, comm);
+    MPI_Allreduce(MPI_IN_PLACE, &documents, 1, MPI_UINT64_T, MPI_SUM, comm);
+  }
+  std::string received(total_of(recv_bytes), '\0');
+  std::vector<std::uint64_t> send_pairs(size);
+  std::vector<std::uint64_t> recv_pairs(size);
+  for (int r = 0; r < size; ++r) {
+    send_pairs[r] = 2 * send_words[r];
+    recv_pairs[r] = 2 * recv_words[r];
+  }
+  std::vector<std::uint64_t> received_stats(total_of(recv_pairs));
+  {
+    TraceScope scope(trace, "MPI_Alltoallv estadísticas poda");
+    alltoallv_large(send_text.data(), send_bytes, received.data(), recv_bytes, MPI_CHAR, comm,
+                    max_message);
+    alltoallv_large(send_stats.data(), send_pairs, received_stats.data(), recv_pairs,
+                    MPI_UINT64_T, comm, max_message);
+  }
+  send_text.clear();
+  send_stats.clear();
+
+  // 2. Suma por palabra: se ordenan los índices recibidos y cada tramo de palabras iguales
+  // comparte un dueño único (`owned`), al que apunta owned_of. Los índices son size_t: un
+  // dueño puede recibir más de 2^32 palabras justo en los vocabularios que se quieren podar.
+  const std::vector<std::string_view> received_words = split_words(received);
+  std::vector<std::size_t> order(received_words.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+    return received_words[lhs] < received_words[rhs];
+  });
+  struct OwnedTerm {
+    std::string_view word;
+    std::uint64_t document_frequency = 0;
+    std::uint64_t total = 0;
+    bool keep = false;
+  };
+  std::vector<OwnedTerm> owned;
+  std::vector<std::size_t> owned_of(received_words.size());
+  for (std::size_t i : order) {
+    if (owned.empty() || owned.back().word != received_words[i]) {
+      owned.push_back({received_words[i]});
+    }
+    owned.back().document_frequency += received_stats[2 * i];
+    owned.back().total += received_stats[2 * i + 1];
+    owned_of[i] = owned.size() - 1;
+  }
+  std::vector<std::size_t> candidates;
+  for (std::size_t t = 0; t < owned.size(); ++t) {
+    owned[t].keep = pruning.keeps_frequency(owned[t].document_frequency, documents);
+    if (owned[t].keep) {
+      candidates.push_back(t);
+    }
+  }
+
+  // 3. Corte global de --max-features.
+  std::uint64_t total_candidates = candidates.size();
+  if (pruning.max_features > 0) {
+    TraceScope scope(trace, "MPI_Allreduce candidatos poda");
+    MPI_Allreduce(MPI_IN_PLACE, &total_candidates, 1, MPI_UINT64_T, MPI_SUM, comm);
+  }
+  if (pruning.max_features > 0 && total_candidates > pruning.max_features) {
+    const auto ranks = [&](std::size_t lhs, std::size_t rhs) {
+      return ranks_before(owned[lhs].total, owned[lhs].word, owned[rhs].total, owned[rhs].word);
+    };
+    // Solo las K mejores de cada dueño pueden quedar entre las K mejores globales.
+    const std::size_t local_best = std::min(candidates.size(), pruning.max_features);
+    std::partial_sort(candidates.begin(), candidates.begin() + local_best, candidates.end(),
+                      ranks);
+    std::string best_text;
+    std::vector<std::uint64_t> best_totals;
+    for (std::size_t c = 0; c < local_best; ++c) {
+      best_text += owned[candidates[c]].word;
+      best_text.push_back('\n');
+      best_totals.push_back(owned[candidates[c]].total);
+    }
+    const std::uint64_t best_sizes[2] = {best_text.size(), local_best};
+    std::vector<std::uint64_t> all_sizes(2 * static_cast<std::size_t>(size));
+    {
+      TraceScope scope(trace, "MPI_Allgather tamaños candidatos");
+      MPI_Allgather(best_sizes, 2, MPI_UINT64_T, all_sizes.data(), 2, MPI_UINT64_T, comm);
+    }
+    std::vector<std::uint64_t> all_bytes(size);
+    std::vector<std::uint64_t> all_words(size);
+    for (int r = 0; r < size; ++r) {
+      all_bytes[r] = all_sizes[2 * r];
+      all_words[r] = all_sizes[2 * r + 1];
+    }
+    std::string all_text(total_of(all_bytes), '\0');
+    std::vector<std::uint64_t> all_totals(total_of(all_words));
+    {
+      TraceScope scope(trace, "MPI_Allgatherv candidatos");
+      allgatherv_large(best_text.data(), MPI_CHAR, all_text.data(), all_bytes, comm,
+                       max_message);
+      allgatherv_large(best_totals.data(), MPI_UINT64_T, all_totals.data(), all_words, comm,
+                       max_message);
+    }
+    // Todos los ranks reciben lo mismo y eligen la misma K-ésima (total, palabra).
+    const std::vector<std::string_view> all_words_text = split_words(all_text);
+    std::vector<std::size_t> global(all_words_text.size());
+    std::iota(global.begin(), global.end(), 0);
+    const auto cutoff = global.begin() + static_cast<std::ptrdiff_t>(pruning.max_features - 1);
+    std::nth_element(global.begin(), cutoff, global.end(), [&](std::size_t lhs,
+                                                               std::size_t rhs) {
+      return ranks_before(all_totals[lhs], all_words_text[lhs], all_totals[rhs],
+                          all_words_text[rhs]);
+    });
+    const std::uint64_t cutoff_total = all_totals[*cutoff];
+    const std::string_view cutoff_word = all_words_text[*cutoff];
+    for (std::size_t t : candidates) {
+      owned[t].keep =
+          !ranks_before(cutoff_total, cutoff_word, owned[t].total, owned[t].word);
+    }
+  }
+
+  // 4. Respuesta en el orden de llegada y traducción a símbolos locales.
+  std::vector<char> reply(received_words.size());
+  for (std::size_t i = 0; i < received_words.size(); ++i) {
+    reply[i] = owned[owned_of[i]].keep ? 1 : 0;
+  }
+  std::vector<char> sent_keep(sent.size());
+  {
+    TraceScope scope(trace, "MPI_Alltoallv respuesta poda");
+    alltoallv_large(reply.data(), recv_words, sent_keep.data(), send_words, MPI_CHAR, comm,
+                    max_message);
+  }
+  std::vector<char> keep(symbols.size(), 0);
+  for (std::size_t i = 0; i < sent.size(); ++i) {
+    keep[sent[i]] = sent_keep[i];
+  }
+  return keep;
+}
+
+}  // namespace bow
@@ -0,0 +1,56 @@
+// engine.cpp: Registro de motores y alta de los motores incluidos en el proyecto.
+#include "bow/engine.hpp"
+
+#include <utility>
+
+#include "bow/hilos.hpp"
+#include "bow/serial.hpp"
+#ifdef BOW_WITH_MPI
+#include "bow/paralelo.hpp"
+#endif
+
+namespace {
+
+// Registro global; se construye en el primer uso para no depender del orden de inicialización.
+std::vector<bow::Engine>& engine_registry() {
+  static std::vector<bow::Engine> registry;
+  return registry;
+}
+
+}  // namespace
+
+namespace bow {
+
+void register_engine(Engine engine) {
+  for (auto& existing : engine_registry()) {
+    if (existing.name == engine.name) {
+      existing = std::move(engine);
+      return;
+    }
+  }
+  engine_registry().push_back(std::move(engine));
+}
+
+const Engine* find_engine(const std::string& name) {
+  for (const auto& engine : engine_registry()) {
+    if (engine.name == name) {
+      return &engine;
+    }
+  }
+  return nullptr;
+}
+
+const std::vector<Engine>& registered_engines() { return engine_registry(); }
+
+void register_builtin_engines() {
+  register_engine({"serial", "Versión secuencial en rank 0 (bow_serial.csv)",
+                   EngineScope::kRootOnly, run_serial});
+  register_engine({"hilos", "Hilos con robo de trabajo en rank 0, sin MPI (bow_threads.csv)",
+                   EngineScope::kRootOnly, run_threaded});
+#ifdef BOW_WITH_MPI
+  register_engine({"mpi", "MPI con reparto round-robin de documentos (bow_mpi.csv)",
+                   EngineScope::kAllRanks, run_parallel});
+#endif
+}
+
+}  // namespace bow
@@ -0,0 +1,189 @@
+// hilos.cpp: Bolsa de palabras con hilos: conteo por documento (y por trozo en los grandes),
+// unión del vocabulario en árbol y construcción de filas en paralelo, en un mismo proceso.
+#include "bow/hilos.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bow/core.hpp"
+#include "bow/memory_stats.hpp"
+#include "bow/metrics.hpp"
+#include "bow/thread_pool.hpp"
+
+namespace {
+
+// Une los vocabularios ordenados de cada hilo por parejas (ronda a ronda, las uniones de una
+// misma ronda corren en paralelo) hasta dejar uno solo en partial[0]. Son símbolos ordenados
+// por su palabra; un mismo símbolo en dos hilos es la misma palabra y queda una sola vez.
+std::vector<bow::SymbolId> merge_vocabularies(std::vector<std::vector<bow::SymbolId>> partial,
+                                              const bow::SymbolTable& symbols,
+                                              int num_threads) {
+  if (partial.empty()) {
+    return {};
+  }
+  const auto by_word = [&symbols](bow::SymbolId lhs, bow::SymbolId rhs) {
+    return symbols.word(lhs) < symbols.word(rhs);
+  };
+  for (std::size_t stride = 1; stride < partial.size(); stride *= 2) {
+    const std::size_t pairs = (partial.size() + 2 * stride - 1) / (2 * stride);
+    bow::parallel_for_work_stealing(pairs, num_threads, [&](std::size_t pair, int) {
+      const std::size_t left = pair * 2 * stride;
+      const std::size_t right = left + stride;
+      if (right >= partial.size()) {
+        return;
+      }
+      std::vector<bow::SymbolId> merged;
+      merged.reserve(partial[left].size() + partial[right].size());
+      std::set_union(partial[left].begin(), partial[left].end(), partial[right].begin(),
+                     partial[right].end(), std::back_inserter(merged), by_word);
+      partial[left] = std::move(merged);
+      partial[right].clear();
+      partial[right].shrink_to_fit();
+    });
+  }
+  return std::move(partial.front());
+}
+
+// Fila densa de un documento: cada conteo cae directo en la columna de su símbolo.
+std::vector<int> build_row(const bow::WordCounts& document_map,
+                           const std::vector<int>& column_of_symbol, std::size_t vocabulary_size) {
+  std::vector<int> row(vocabulary_size, 0);
+  for (const auto& entry : document_map) {
+    row[column_of_symbol[entry.first]] = entry.second;
+  }
+  return row;
+}
+
+}  // namespace
+
+namespace bow {
+
+ExperimentResult run_threaded(const ExperimentConfig& config) {
+  ExperimentResult result;
+  if (config.document_paths.empty()) {
+    std::cerr << "No hay documentos para procesar." << std::endl;
+    return result;
+  }
+
+  const int num_threads = resolve_thread_count(config.num_threads);
+  PhaseRecorder recorder({"conteo_en_hilos", "poda", "vocabulario", "idf", "matriz", "escritura"},
+                         config.collect_perf_counters);
+  reset_peak_rss();
+  const auto start_time = std::chrono::steady_clock::now();
+
+  // Cada hilo acumula su propio vocabulario parcial con los documentos que terminó de contar,
+  // así la fase de conteo no necesita candados. Son símbolos distintos, aún sin ordenar.
+  std::vector<std::vector<SymbolId>> words_by_thread(num_threads);
+  std::vector<std::vector<char>> seen_by_thread(num_threads);
+
+  recorder.begin("conteo_en_hilos");
+  DocumentCounts documents = count_documents_in_tasks(
+      config.document_paths, config, num_threads,
+      [&](std::size_t, const WordCounts& counts, int worker) {
+        auto& words = words_by_thread[worker];
+        auto& seen = seen_by_thread[worker];
+        for (const auto& entry : counts) {
+          if (entry.first >= seen.size()) {
+            seen.resize(std::max<std::size_t>(entry.first + 1, seen.size() * 2), 0);
+          }
+          if (seen[entry.first] == 0) {
+            seen[entry.first] = 1;
+            words.push_back(entry.first);
+          }
+        }
+      });
+  seen_by_thread.clear();
+  std::vector<WordCounts>& document_counts = documents.counts;
+  std::vector<std::string> processed_names;
+  processed_names.reserve(documents.positions.size());
+  for (std::size_t position : documents.positions) {
+    processed_names.push_back(
+        std::filesystem::path(config.document_paths[position]).filename().string());
+  }
+  recorder.end();
+
+  if (document_counts.empty()) {
+    std::cerr << "No se pudo procesar ningún documento válido." << std::endl;
+    return result;
+  }
+
+  const SymbolTable& symbols = *documents.symbols;
+  if (config.pruning.enabled()) {
+    // Los vocabularios parciales se filtran con la misma máscara que los conteos, así que
+    // build_row nunca ve un símbolo sin columna.
+    recorder.begin("poda");
+    const std::vector<char> keep = prune_symbols(symbols, document_counts, config.pruning);
+    drop_pruned(document_counts, keep);
+    for (auto& words : words_by_thread) {
+      words.erase(std::remove_if(words.begin(), words.end(),
+                                 [&](SymbolId id) { return keep[id] == 0; }),
+                  words.end());
+    }
+  }
+
+  recorder.begin("vocabulario");
+  parallel_for_work_stealing(words_by_thread.size(), num_threads, [&](std::size_t t, int) {
+    symbols.sort_by_word(words_by_thread[t]);
+  });
+  const std::vector<SymbolId> merged =
+      merge_vocabularies(std::move(words_by_thread), symbols, num_threads);
+  std::vector<std::string> vocabulary;
+  vocabulary.reserve(merged.size());
+  std::vector<int> column_of_symbol(symbols.size(), -1);
+  for (std::size_t column = 0; column < merged.size(); ++column) {
+    vocabulary.emplace_back(symbols.word(merged[column]));
+    column_of_symbol[merged[column]] = static_cast<int>(column);
+  }
+
+  const std::filesystem::path output_file = std::filesystem::path("results") / "bow_threads.csv";
+  std::filesystem::create_directories(output_file.parent_path());
+  if (config.tfidf.enabled) {
+    recorder.begin("idf");
+    const std::vector<double> idf = inverse_document_frequency(
+        column_document_frequency(document_counts, column_of_symbol, vocabulary.size()),
+        document_counts.size(), config.tfidf.smooth_idf);
+    recorder.begin("matriz");
+    std::vector<std::vector<float>> matrix(document_counts.size());
+    std::vector<std::vector<std::pair<int, double>>> scratch(num_threads);
+    parallel_for_work_stealing(
+        document_counts.size(), num_threads,
+        [&](std::size_t i, int worker) {
+          matrix[i].assign(vocabulary.size(), 0.0f);
+          weight_row(document_counts[i], column_of_symbol, idf, config.tfidf.sublinear_tf,
+                     matrix[i].data(), scratch[worker]);
+        },
+        &documents.scheduler);
+    recorder.begin("escritura");
+    write_csv(matrix, vocabulary, processed_names, output_file.string());
+  } else {
+    recorder.begin("matriz");
+    std::vector<std::vector<int>> matrix(document_counts.size());
+    parallel_for_work_stealing(
+        document_counts.size(), num_threads,
+        [&](std::size_t i, int) {
+          matrix[i] = build_row(document_counts[i], column_of_symbol, vocabulary.size());
+        },
+        &documents.scheduler);
+    recorder.begin("escritura");
+    write_csv(matrix, vocabulary, processed_names, output_file.string());
+  }
+  recorder.end();
+
+  const auto end_time = std::chrono::steady_clock::now();
+  const double elapsed_ms =
+      std::chrono::duration<double, std::milli>(end_time - start_time).count();
+  result.total_time_ms = elapsed_ms;
+  result.average_time_ms = elapsed_ms;
+  result.phases = recorder.phases();
+  result.peak_rss_bytes = {peak_rss_bytes()};
+  result.scheduler = documents.scheduler;
+  return result;
+}
+
+}  // namespace bow
@@ -0,0 +1,356 @@
+// large_count_mpi.cpp: Estrategias de recolección/difusión cuando los conteos no caben en int.
+#include "bow/large_count.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Etiqueta de los trozos. Basta una sola: MPI no deja que mensajes entre el mismo par de
+// ranks con la misma etiqueta se adelanten, y emisor y receptor publican los trozos de cada
+// recolección (y las recolecciones entre sí) en el mismo orden.
+constexpr int kChunkedGatherTag = 7400;
+constexpr int kChunkedExchangeTag = 7401;  // allgatherv_large y alltoallv_large.
+
+enum class GatherStrategy { kInt, kLargeCount, kChunked };
+
+GatherStrategy choose_strategy(const std::vector<std::uint64_t>& counts,
+                               std::uint64_t max_message) {
+  max_message = std::min(max_message, bow::kMaxMessageElements);
+  std::uint64_t total = 0;
+  for (std::uint64_t count : counts) {
+    total += count;
+  }
+  if (total <= max_message) {
+    return GatherStrategy::kInt;
+  }
+#if MPI_VERSION >= 4
+  if (max_message == bow::kMaxMessageElements) {
+    return GatherStrategy::kLargeCount;
+  }
+#endif
+  return GatherStrategy::kChunked;
+}
+
+std::uint64_t extent_of(MPI_Datatype type) {
+  MPI_Aint lower_bound = 0;
+  MPI_Aint extent = 0;
+  MPI_Type_get_extent(type, &lower_bound, &extent);
+  return static_cast<std::uint64_t>(extent);
+}
+
+// Publica los envíos/recepciones en trozos; rank 0 copia su propio bloque directamente.
+void post_chunked(const void* send, MPI_Datatype type, void* recv,
+                  const std::vector<std::uint64_t>& counts, MPI_Comm comm,
+                  std::uint64_t max_message, std::vector<MPI_Request>& requests) {
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+  const std::uint64_t extent = extent_of(type);
+  const std::uint64_t chunk = std::max<std::uint64_t>(
+      1, std::min(max_message, bow::kMaxMessageElements));
+
+  if (rank != 0) {
+    const char* data = static_cast<const char*>(send);
+    for (std::uint64_t offset = 0; offset < counts[rank]; offset += chunk) {
+      const int length = static_cast<int>(std::min(chunk, counts[rank] - offset));
+      requests.emplace_back();
+      MPI_Isend(data + offset * extent, length, type, 0, kChunkedGatherTag, comm,
+                &requests.back());
+    }
+    return;
+  }
+
+  char* target = static_cast<char*>(recv);
+  std::uint64_t displacement = 0;
+  for (std::size_t source = 0; source < counts.size(); ++source) {
+    if (source == 0) {
+      if (counts[0] > 0) {
+        std::memcpy(target, send, counts[0] * extent);
+      }
+    } else {
+      for (std::uint64_t offset = 0; offset < counts[source]; offset += chunk) {
+        const int length = static_cast<int>(std::min(chunk, counts[source] - offset));
+        requests.emplace_back();
+        MPI_Irecv(target + (displacement + offset) * extent, length, type,
+                  static_cast<int>(source), kChunkedGatherTag, comm, &requests.back());
+      }
+    }
+    displacement += counts[source];
+  }
+}
+
+// Intercambio en trozos punto a punto entre todos los pares de ranks (allgatherv y
+// alltoallv sin MPI-4 o con --max-msg). Cada par usa el mismo tamaño de trozo en ambos
+// extremos, así los trozos de un bloque llegan en orden a su lugar.
+void exchange_chunked(const void* send, const std::vector<std::uint64_t>& send_counts,
+                      const std::vector<std::uint64_t>& send_displs, void* recv,
+                      const std::vector<std::uint64_t>& recv_counts,
+                      const std::vector<std::uint64_t>& recv_displs, MPI_Datatype type,
+                      MPI_Comm comm, std::uint64_t max_message) {
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+  const std::uint64_t extent = extent_of(type);
+  const std::uint64_t chunk = std::max<std::uint64_t>(
+      1, std::min(max_message, bow::kMaxMessageElements));
+  const char* source = static_cast<const char*>(send);
+  char* target = static_cast<char*>(recv);
+
+  std::vector<MPI_Request> requests;
+  for (std::size_t peer = 0; peer < recv_counts.size(); ++peer) {
+    if (static_cast<int>(peer) == rank) {
+      if (recv_counts[peer] > 0) {
+        std::memcpy(target + recv_displs[peer] * extent, source + send_displs[peer] * extent,
+                    recv_counts[peer] * extent);
+      }
+      continue;
+    }
+    for (std::uint64_t offset = 0; offset < recv_counts[peer]; offset += chunk) {
+      const int length = static_cast<int>(std::min(chunk, recv_counts[peer] - offset));
+      requests.emplace_back();
+      MPI_Irecv(target + (recv_displs[peer] + offset) * extent, length, type,
+                static_cast<int>(peer), kChunkedExchangeTag, comm, &requests.back());
+    }
+    for (std::uint64_t offset = 0; offset < send_counts[peer]; offset += chunk) {
+      const int length = static_cast<int>(std::min(chunk, send_counts[peer] - offset));
+      requests.emplace_back();
+      MPI_Isend(source + (send_displs[peer] + offset) * extent, length, type,
+                static_cast<int>(peer), kChunkedExchangeTag, comm, &requests.back());
+    }
+  }
+  if (!requests.empty()) {
+    MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+  }
+}
+
+// Sumas prefijas exclusivas de `counts`.
+std::vector<std::uint64_t> prefix_offsets(const std::vector<std::uint64_t>& counts) {
+  std::vector<std::uint64_t> offsets(counts.size(), 0);
+  for (std::size_t i = 1; i < counts.size(); ++i) {
+    offsets[i] = offsets[i - 1] + counts[i - 1];
+  }
+  return offsets;
+}
+
+// Llena los conteos/desplazamientos int (solo válidos con la estrategia kInt).
+void fill_int_layout(const std::vector<std::uint64_t>& counts, std::vector<int>& int_counts,
+                     std::vector<int>& int_displs) {
+  int_counts.resize(counts.size());
+  int_displs.resize(counts.size());
+  int running = 0;
+  for (std::size_t i = 0; i < counts.size(); ++i) {
+    int_counts[i] = static_cast<int>(counts[i]);
+    int_displs[i] = running;
+    running += int_counts[i];
+  }
+}
+
+#if MPI_VERSION >= 4
+void fill_large_layout(const std::vector<std::uint64_t>& counts,
+                       std::vector<MPI_Count>& large_counts, std::vector<MPI_Aint>& large_displs) {
+  large_counts.resize(counts.size());
+  large_displs.resize(counts.size());
+  MPI_Aint running = 0;
+  for (std::size_t i = 0; i < counts.size(); ++i) {
+    large_counts[i] = static_cast<MPI_Count>(counts[i]);
+    large_displs[i] = running;
+    running += static_cast<MPI_Aint>(counts[i]);
+  }
+}
+#endif
+
+}  // namespace
+
+namespace bow {
+
+void PendingGather::wait() {
+  if (!requests.empty()) {
+    MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+    requests.clear();
+  }
+}
+
+void gatherv_large(const void* send, MPI_Datatype type, void* recv,
+                   const std::vector<std::uint64_t>& counts, MPI_Comm comm,
+                   std::uint64_t max_message) {
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+  const bool root = rank == 0;
+
+  switch (choose_strategy(counts, max_message)) {
+    case GatherStrategy::kInt: {
+      std::vector<int> int_counts;
+      std::vector<int> int_displs;
+      fill_int_layout(counts, int_counts, int_displs);
+      MPI_Gatherv(send, int_counts[rank], type, recv, root ? int_counts.data() : nullptr,
+                  root ? int_displs.data() : nullptr, type, 0, comm);
+      return;
+    }
+    case GatherStrategy::kLargeCount: {
+#if MPI_VERSION >= 4
+      std::vector<MPI_Count> large_counts;
+      std::vector<MPI_Aint> large_displs;
+      fill_large_layout(counts, large_counts, large_displs);
+      MPI_Gatherv_c(send, large_counts[rank], type, recv, root ? large_counts.data() : nullptr,
+                    root ? large_displs.data() : nullptr, type, 0, comm);
+#endif
+      return;
+    }
+    case GatherStrategy::kChunked: {
+      PendingGather pending;
+      post_chunked(send, type, recv, counts, comm, max_message, pending.requests);
+      pending.wait();
+      return;
+    }
+  }
+}
+
+PendingGather igatherv_large(const void* send, MPI_Datatype type, void* recv,
+                             const std::vector<std::uint64_t>& counts, MPI_Comm comm,
+                             std::uint64_t max_message) {
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+  const bool root = rank == 0;
+  PendingGather pending;
+
+  switch (choose_strategy(counts, max_message)) {
+    case GatherStrategy::kInt:
+      fill_int_layout(counts, pending.counts, pending.displs);
+      pending.requests.emplace_back();
+      MPI_Igatherv(send, pending.counts[rank], type, recv,
+                   root ? pending.counts.data() : nullptr, root ? pending.displs.data() : nullptr,
+                   type, 0, comm, &pending.requests.back());
+      break;
+    case GatherStrategy::kLargeCount:
+#if MPI_VERSION >= 4
+      fill_large_layout(counts, pending.large_counts, pending.large_displs);
+      pending.requests.emplace_back();
+      MPI_Igatherv_c(send, pending.large_counts[rank], type, recv,
+                     root ? pending.large_counts.data() : nullptr,
+                     root ? pending.large_displs.data() : nullptr, type, 0, comm,
+                     &pending.requests.back());
+#endif
+      break;
+    case GatherStrategy::kChunked:
+      post_chunked(send, type, recv, counts, comm, max_message, pending.requests);
+      break;
+  }
+  return pending;
+}
+
+void bcast_large(void* data, std::uint64_t count, MPI_Datatype type, MPI_Comm comm,
+                 std::uint64_t max_message) {
+  max_message = std::max<std::uint64_t>(1, std::min(max_message, kMaxMessageElements));
+#if MPI_VERSION >= 4
+  if (count > kMaxMessageElements && max_message == kMaxMessageElements) {
+    MPI_Bcast_c(data, static_cast<MPI_Count>(count), type, 0, comm);
+    return;
+  }
+#endif
+  if (count == 0) {
+    MPI_Bcast(data, 0, type, 0, comm);
+    return;
+  }
+  char* bytes = static_cast<char*>(data);
+  const std::uint64_t extent = extent_of(type);
+  for (std::uint64_t offset = 0; offset < count; offset += max_message) {
+    const int length = static_cast<int>(std::min(max_message, count - offset));
+    MPI_Bcast(bytes + offset * extent, length, type, 0, comm);
+  }
+}
+
+void allgatherv_large(const void* send, MPI_Datatype type, void* recv,
+                      const std::vector<std::uint64_t>& counts, MPI_Comm comm,
+                      std::uint64_t max_message) {
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  switch (choose_strategy(counts, max_message)) {
+    case GatherStrategy::kInt: {
+      std::vector<int> int_counts;
+      std::vector<int> int_displs;
+      fill_int_layout(counts, int_counts, int_displs);
+      MPI_Allgatherv(send, int_counts[rank], type, recv, int_counts.data(), int_displs.data(),
+                     type, comm);
+      return;
+    }
+    case GatherStrategy::kLargeCount: {
+#if MPI_VERSION >= 4
+      std::vector<MPI_Count> large_counts;
+      std::vector<MPI_Aint> large_displs;
+      fill_large_layout(counts, large_counts, large_displs);
+      MPI_Allgatherv_c(send, large_counts[rank], type, recv, large_counts.data(),
+                       large_displs.data(), type, comm);
+#endif
+      return;
+    }
+    case GatherStrategy::kChunked: {
+      // Cada rank manda su único bloque a todos los demás.
+      const std::vector<std::uint64_t> send_counts(counts.size(), counts[rank]);
+      const std::vector<std::uint64_t> send_displs(counts.size(), 0);
+      exchange_chunked(send, send_counts, send_displs, recv, counts, prefix_offsets(counts),
+                       type, comm, max_message);
+      return;
+    }
+  }
+}
+
+void alltoallv_large(const void* send, const std::vector<std::uint64_t>& send_counts,
+                     void* recv, const std::vector<std::uint64_t>& recv_counts,
+                     MPI_Datatype type, MPI_Comm comm, std::uint64_t max_message) {
+  std::uint64_t volume[2] = {0, 0};  // {enviado, recibido} por este rank.
+  for (std::size_t peer = 0; peer < send_counts.size(); ++peer) {
+    volume[0] += send_counts[peer];
+    volume[1] += recv_counts[peer];
+  }
+  MPI_Allreduce(MPI_IN_PLACE, volume, 2, MPI_UINT64_T, MPI_MAX, comm);
+
+  switch (choose_strategy({std::max(volume[0], volume[1])}, max_message)) {
+    case GatherStrategy::kInt: {
+      std::vector<int> int_send_counts;
+      std::vector<int> int_send_displs;
+      std::vector<int> int_recv_counts;
+      std::vector<int> int_recv_displs;
+      fill_int_layout(send_counts, int_send_counts, int_send_displs);
+      fill_int_layout(recv_counts, int_recv_counts, int_recv_displs);
+      MPI_Alltoallv(send, int_send_counts.data(), int_send_displs.data(), type, recv,
+                    int_recv_counts.data(), int_recv_displs.data(), type, comm);
+      return;
+    }
+    case GatherStrategy::kLargeCount: {
+#if MPI_VERSION >= 4
+      std::vector<MPI_Count> large_send_counts;
+      std::vector<MPI_Aint> large_send_displs;
+      std::vector<MPI_Count> large_recv_counts;
+      std::vector<MPI_Aint> large_recv_displs;
+      fill_large_layout(send_counts, large_send_counts, large_send_displs);
+      fill_large_layout(recv_counts, large_recv_counts, large_recv_displs);
+      MPI_Alltoallv_c(send, large_send_counts.data(), large_send_displs.data(), type, recv,
+                      large_recv_counts.data(), large_recv_displs.data(), type, comm);
+#endif
+      return;
+    }
+    case GatherStrategy::kChunked:
+      exchange_chunked(send, send_counts, prefix_offsets(send_counts), recv, recv_counts,
+                       prefix_offsets(recv_counts), type, comm, max_message);
+      return;
+  }
+}
+
+void allreduce_large(void* data, std::uint64_t count, MPI_Datatype type, MPI_Op op,
+                     MPI_Comm comm, std::uint64_t max_message) {
+  max_message = std::max<std::uint64_t>(1, std::min(max_message, kMaxMessageElements));
+#if MPI_VERSION >= 4
+  if (count > kMaxMessageElements && max_message == kMaxMessageElements) {
+    MPI_Allreduce_c(MPI_IN_PLACE, data, static_cast<MPI_Count>(count), type, op, comm);
+    return;
+  }
+#endif
+  char* bytes = static_cast<char*>(data);
+  const std::uint64_t extent = extent_of(type);
+  for (std::uint64_t offset = 0; offset < count; offset += max_message) {
+    const int length = static_cast<int>(std::min(max_message, count - offset));
+    MPI_Allreduce(MPI_IN_PLACE, bytes + offset * extent, length, type, op, comm);
+  }
+}
+
+}  // namespace bow
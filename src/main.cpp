@@ -1,17 +1,52 @@
-// main.cpp: Punto de entrada que orquesta corridas seriales y paralelas, y calcula speed-up.
+// main.cpp: Punto de entrada que orquesta los motores seleccionados y compara su speed-up.
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#ifdef BOW_WITH_MPI
 #include <mpi.h>
+#endif
 
-#include "bow/paralelo.hpp"
-#include "bow/serial.hpp"
+#include "bow/engine.hpp"
+#include "bow/stop_words.hpp"
+#include "bow/streaming.hpp"
 
 namespace {
 
+// Envolturas mínimas del runtime MPI: sin BOW_WITH_MPI el programa corre como un único rank
+// y solo quedan disponibles los motores que no usan MPI.
+void init_runtime(int& world_rank, int& world_size) {
+#ifdef BOW_WITH_MPI
+  MPI_Init(nullptr, nullptr);
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+#else
+  world_rank = 0;
+  world_size = 1;
+#endif
+}
+
+void barrier_runtime() {
+#ifdef BOW_WITH_MPI
+  MPI_Barrier(MPI_COMM_WORLD);
+#endif
+}
+
+void finalize_runtime() {
+#ifdef BOW_WITH_MPI
+  MPI_Finalize();
+#endif
+}
+
 // Carga la lista de archivos desde un archivo de texto plano (uno por línea).
 std::vector<std::string> load_document_names(const std::string& list_path) {
   std::vector<std::string> names;
@@ -52,23 +87,297 @@ std::vector<std::string> resolve_document_paths(const std::string& list_path,
   return resolved;
 }
 
+// Conserva, por rank, el mayor pico de memoria observado entre experimentos.
+void keep_max_per_rank(std::vector<std::uint64_t>& maximum, const std::vector<std::uint64_t>& run) {
+  if (maximum.size() < run.size()) {
+    maximum.resize(run.size(), 0);
+  }
+  for (std::size_t i = 0; i < run.size(); ++i) {
+    maximum[i] = std::max(maximum[i], run[i]);
+  }
+}
+
+// Reporta cuánta lectura quedó oculta detrás de la tokenización gracias al prefetch.
+void print_hidden_io(const std::string& title, const double io[2], int runs) {
+  const double read_ms = io[0] / runs;
+  const double wait_ms = io[1] / runs;
+  const double hidden_ms = read_ms > wait_ms ? read_ms - wait_ms : 0.0;
+  std::cout << "E/S oculta por prefetch " << title << ": " << hidden_ms << " ms de " << read_ms
+            << " ms de lectura (" << (read_ms > 0.0 ? 100.0 * hidden_ms / read_ms : 0.0) << "%)"
+            << std::endl;
+}
+
+// Divide una lista separada por comas ("serial,mpi") descartando elementos vacíos.
+std::vector<std::string> split_by_comma(const std::string& list) {
+  std::vector<std::string> parts;
+  std::stringstream input(list);
+  std::string part;
+  while (std::getline(input, part, ',')) {
+    if (!part.empty()) {
+      parts.push_back(part);
+    }
+  }
+  return parts;
+}
+
+// Resultados acumulados de un motor a lo largo de los experimentos.
+struct EngineTotals {
+  const bow::Engine* engine = nullptr;
+  double total_ms = 0.0;
+  std::vector<bow::PhaseMetrics> phases;
+  std::vector<std::uint64_t> peak_rss;
+  double io[2] = {0.0, 0.0};  // Lectura total y espera por E/S.
+  bow::SchedulerStats scheduler;
+};
+
+// Tabla comparativa de todos los motores; el speed-up es contra "serial" si se ejecutó, o
+// contra el primer motor seleccionado.
+void print_engine_comparison(const std::vector<EngineTotals>& totals, int runs) {
+  double baseline_ms = totals.front().total_ms / runs;
+  for (const auto& entry : totals) {
+    if (entry.engine->name == "serial") {
+      baseline_ms = entry.total_ms / runs;
+    }
+  }
+
+  const auto flags = std::cout.flags();
+  const auto precision = std::cout.precision();
+  std::cout << std::left << std::setw(16) << "Motor" << std::right << std::setw(22)
+            << "Tiempo promedio (ms)" << std::setw(12) << "Speed-up" << std::endl;
+  for (const auto& entry : totals) {
+    const double average_ms = entry.total_ms / runs;
+    std::cout << std::left << std::setw(16) << entry.engine->name << std::right << std::fixed
+              << std::setprecision(3) << std::setw(22) << average_ms << std::setw(12)
+              << (average_ms > 0.0 ? baseline_ms / average_ms : 0.0) << std::endl;
+  }
+  std::cout.flags(flags);
+  std::cout.precision(precision);
+}
+
+// Traduce un entero sin signo escrito solo con dígitos. std::stoull aceptaría "-1" como
+// 2^64 - 1 y lanzaría una excepción con "abc"; aquí ambos casos regresan false.
+bool parse_unsigned(const std::string& text, std::uint64_t& value) {
+  if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  errno = 0;
+  const unsigned long long parsed = std::strtoull(text.c_str(), nullptr, 10);
+  if (errno == ERANGE) {
+    return false;
+  }
+  value = parsed;
+  return true;
+}
+
+// Lee las opciones que siguen a los argumentos posicionales (ej. --perf, --trace <ruta>).
+// Regresa false si alguna opción no es reconocida.
+bool parse_options(int argc, char** argv, bow::ExperimentConfig& config,
+                   std::vector<std::string>& engine_names, int world_rank) {
+  std::string stop_word_sources;
+  for (int i = 4; i < argc; ++i) {
+    const std::string option = argv[i];
+    if (option == "--engines" && i + 1 < argc) {
+      engine_names = split_by_comma(argv[++i]);
+    } else if (option == "--perf") {
+      config.collect_perf_counters = true;
+    } else if (option == "--trace" && i + 1 < argc) {
+      config.trace_path = argv[++i];
+    } else if (option == "--stream") {
+      config.stream_block_bytes = bow::kDefaultStreamBlockBytes;
+      if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+        config.stream_block_bytes = std::stoul(argv[++i]);
+      }
+    } else if (option == "--prefetch") {
+      config.prefetch_documents = true;
+    } else if (option == "--reader" && i + 1 < argc &&
+               bow::parse_reader_backend(argv[i + 1], config.reader_backend)) {
+      ++i;
+    } else if (option == "--tokenizer" && i + 1 < argc &&
+               bow::parse_tokenizer_mode(argv[i + 1], config.tokenizer)) {
+      ++i;
+    } else if (option == "--stop-words" && i + 1 < argc) {
+      stop_word_sources = argv[++i];
+    } else if (option == "--stem" && i + 1 < argc &&
+               bow::parse_stemmer_language(argv[i + 1], config.stemmer)) {
+      ++i;
+    } else if (option == "--ngrams" && i + 1 < argc &&
+               bow::parse_ngram_range(argv[i + 1], bow::kMaxNgramLength, config.word_ngrams)) {
+      ++i;
+    } else if (option == "--char-ngrams" && i + 1 < argc &&
+               bow::parse_ngram_range(argv[i + 1], bow::kMaxCharNgramLength,
+                                      config.char_ngrams)) {
+      ++i;
+    } else if ((option == "--min-df" || option == "--max-df" || option == "--max-features") &&
+               i + 1 < argc) {
+      const std::string value = argv[++i];
+      const bool valid =
+          option == "--min-df"   ? bow::parse_document_frequency(value, config.pruning.min_df)
+          : option == "--max-df" ? bow::parse_document_frequency(value, config.pruning.max_df)
+                                 : bow::parse_max_features(value, config.pruning.max_features);
+      if (!valid) {
+        if (world_rank == 0) {
+          std::cerr << "valor inválido para " << option << ": " << value << std::endl;
+        }
+        return false;
+      }
+    } else if (option == "--tfidf") {
+      config.tfidf.enabled = true;
+      if (i + 1 < argc && argv[i + 1][0] != '-') {
+        if (!bow::parse_tfidf_options(argv[++i], config.tfidf)) {
+          if (world_rank == 0) {
+            std::cerr << "Opciones de --tfidf desconocidas: " << argv[i] << std::endl;
+          }
+          return false;
+        }
+      }
+    } else if (option == "--batch" && i + 1 < argc) {
+      config.read_batch_size = std::stoul(argv[++i]);
+    } else if (option == "--shared-vocab") {
+      config.shared_vocabulary = true;
+    } else if (option == "--hierarchical") {
+      config.hierarchical_collectives = true;
+    } else if (option == "--nonblocking") {
+      config.nonblocking_collectives = true;
+    } else if (option == "--max-msg" && i + 1 < argc) {
+      const std::string value = argv[++i];
+      if (!parse_unsigned(value, config.max_message_elements)) {
+        if (world_rank == 0) {
+          std::cerr << "valor inválido para --max-msg: " << value << std::endl;
+        }
+        return false;
+      }
+      if (config.max_message_elements == 0) {
+        // Con 0 los trozos no avanzarían: cada colectiva partida se quedaría en un ciclo.
+        if (world_rank == 0) {
+          std::cerr << "--max-msg debe ser al menos 1" << std::endl;
+        }
+        return false;
+      }
+    } else if (option == "--sample-sort") {
+      config.sample_sort_vocabulary = true;
+    } else if (option == "--stream-gather") {
+      config.gather_batch_documents = bow::kDefaultGatherBatchDocuments;
+      if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+        config.gather_batch_documents = std::stoul(argv[++i]);
+      }
+    } else if (option == "--threads" && i + 1 < argc) {
+      config.num_threads = std::stoi(argv[++i]);
+    } else {
+      if (world_rank == 0) {
+        std::cerr << "Opción desconocida: " << option << std::endl;
+      }
+      return false;
+    }
+  }
+  if (config.char_ngrams.max > 0 &&
+      (config.stemmer != bow::StemmerLanguage::kNone || config.word_ngrams.max > 1)) {
+    if (world_rank == 0) {
+      std::cerr << "--char-ngrams no se combina con --stem ni con --ngrams" << std::endl;
+    }
+    return false;
+  }
+  // Se normalizan con el tokenizador elegido, así que se cargan después de leer --tokenizer.
+  if (!stop_word_sources.empty()) {
+    config.stop_words = bow::load_stop_words(split_by_comma(stop_word_sources), config.tokenizer);
+    if (config.stop_words == nullptr) {
+      return false;
+    }
+    if (world_rank == 0) {
+      std::cout << "Palabras vacías (" << stop_word_sources << "): " << config.stop_words->size()
+                << std::endl;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
   // Inicializamos MPI una única vez para toda la orquestación.
-  MPI_Init(nullptr, nullptr);
-
   int world_rank = 0;
   int world_size = 1;
-  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
-  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+  init_runtime(world_rank, world_size);
+
+  bow::register_builtin_engines();
 
   if (argc < 4) {
     if (world_rank == 0) {
       std::cerr << "Uso: " << argv[0]
-                << " <num_procesos> <ruta_lista_archivos> <num_experimentos>" << std::endl;
+                << " <num_procesos> <ruta_lista_archivos> <num_experimentos> [opciones]"
+                << std::endl;
+      std::cerr << "Opciones:" << std::endl;
+      std::cerr << "  --engines <a,b>  Motores a comparar (defecto serial,mpi). Disponibles:"
+                << std::endl;
+      for (const auto& engine : bow::registered_engines()) {
+        std::cerr << "                     " << engine.name << ": " << engine.description
+                  << std::endl;
+      }
+      std::cerr << "  --perf           Contadores de hardware por fase (IPC, caché, saltos, TLB)"
+                << std::endl;
+      std::cerr << "  --trace <ruta>   Línea de tiempo MPI por rank en formato Chrome trace JSON"
+                << std::endl;
+      std::cerr << "  --stream [bytes] Lee, tokeniza y cuenta por bloques (por defecto 64 KiB)"
+                << std::endl;
+      std::cerr << "  --prefetch       Lee el siguiente documento mientras se tokeniza el actual"
+                << std::endl;
+      std::cerr << "  --reader <tipo>  Backend de lectura: ifstream (defecto), io_uring o pread"
+                << std::endl;
+      std::cerr << "  --batch <n>      Documentos por lote para io_uring/pread (defecto 64)"
+                << std::endl;
+      std::cerr << "  --tokenizer <m>  ascii (defecto) o utf8: letras acentuadas y plegado de"
+                << std::endl;
+      std::cerr << "                   mayúsculas latinas (Ñ -> ñ)"
+                << std::endl;
+      std::cerr << "  --stop-words <l> Descarta palabras vacías: en, es y/o rutas de archivo,"
+                << std::endl;
+      std::cerr << "                   separadas por comas"
+                << std::endl;
+      std::cerr << "  --stem <idioma>  Cuenta raíces en vez de palabras: en (Porter) o es"
+                << std::endl;
+      std::cerr << "                   (Snowball; conviene con --tokenizer utf8)"
+                << std::endl;
+      std::cerr << "  --ngrams <n[,m]> Cuenta n-gramas de palabras de n a m (hasta 3); 1,1 por"
+                << std::endl;
+      std::cerr << "                   defecto, 2 solo bigramas, 1,2 palabras y bigramas"
+                << std::endl;
+      std::cerr << "  --char-ngrams <n[,m]> Cuenta n-gramas de caracteres de cada palabra, de n"
+                << std::endl;
+      std::cerr << "                   a m (hasta 8), en vez de las palabras; ej. 3,5"
+                << std::endl;
+      std::cerr << "  --min-df <n|p>   Descarta términos en menos de n documentos (o de la"
+                << std::endl;
+      std::cerr << "                   proporción p, ej. 0.01) del corpus"
+                << std::endl;
+      std::cerr << "  --max-df <n|p>   Descarta términos en más de n documentos (o de p, ej. 0.9)"
+                << std::endl;
+      std::cerr << "  --max-features <k> Conserva los k términos con más apariciones en el corpus"
+                << std::endl;
+      std::cerr << "  --tfidf [o,...]  Escribe pesos TF-IDF normalizados (l2) en vez de conteos;"
+                << std::endl;
+      std::cerr << "                   opciones: sublinear (1 + ln tf), nosmooth (idf sin +1)"
+                << std::endl;
+      std::cerr << "  --shared-vocab   Vocabulario e índice en memoria compartida, uno por nodo"
+                << std::endl;
+      std::cerr << "  --hierarchical   Reúne vocabulario y filas por nodo y luego entre líderes"
+                << std::endl;
+      std::cerr << "  --nonblocking    Vocabulario por bloques con MPI_Ibcast y recolección con"
+                << std::endl;
+      std::cerr << "                   MPI_Igatherv, solapadas con el armado de filas"
+                << std::endl;
+      std::cerr << "  --max-msg <n>    Elementos máximos por mensaje MPI antes de partir en trozos"
+                << std::endl;
+      std::cerr << "  --sample-sort    Ordena el vocabulario global con sample sort distribuido"
+                << std::endl;
+      std::cerr << "  --stream-gather [n] Reúne las filas en rank 0 por lotes de n documentos"
+                << std::endl;
+      std::cerr << "                   (defecto 64) y las escribe al llegar"
+                << std::endl;
+      std::cerr << "  --threads <n>    Hilos del motor hilos (defecto: núcleos); n > 1 también en"
+                << std::endl;
+      std::cerr << "                   el conteo de serial y de cada rank MPI"
+                << std::endl;
     }
-    MPI_Finalize();
+    finalize_runtime();
     return 1;
   }
 
@@ -98,46 +407,97 @@ int main(int argc, char** argv) {
   base_config.list_path = list_path;
   base_config.num_experiments = num_experiments;
   base_config.document_paths = resolve_document_paths(list_path, documents);
+#ifdef BOW_WITH_MPI
+  std::vector<std::string> engine_names = {"serial", "mpi"};
+#else
+  std::vector<std::string> engine_names = {"serial", "hilos"};
+#endif
+  if (!parse_options(argc, argv, base_config, engine_names, world_rank)) {
+    finalize_runtime();
+    return 1;
+  }
+
+  std::vector<EngineTotals> totals;
+  for (const auto& name : engine_names) {
+    const bow::Engine* engine = bow::find_engine(name);
+    if (engine == nullptr) {
+      if (world_rank == 0) {
+        std::cerr << "Motor desconocido: " << name << ". Disponibles:";
+        for (const auto& available : bow::registered_engines()) {
+          std::cerr << " " << available.name;
+        }
+        std::cerr << std::endl;
+      }
+      finalize_runtime();
+      return 1;
+    }
+    totals.push_back({engine, 0.0, {}, {}, {0.0, 0.0}, {}});
+  }
+  if (totals.empty()) {
+    if (world_rank == 0) {
+      std::cerr << "No se seleccionó ningún motor." << std::endl;
+    }
+    finalize_runtime();
+    return 1;
+  }
+  if (world_rank == 0 && base_config.collect_perf_counters && !bow::PerfCounterSet().available()) {
+    std::cerr << "Advertencia: perf_event_open no está disponible, solo se reportan tiempos."
+              << std::endl;
+  }
   if (base_config.document_paths.empty()) {
     if (world_rank == 0) {
       std::cerr << "No se pudo resolver ninguna ruta válida de documentos." << std::endl;
     }
-    MPI_Finalize();
+    finalize_runtime();
     return 1;
   }
 
-  double serial_total = 0.0;
-  double parallel_total = 0.0;
-
   for (int i = 0; i < num_experiments; ++i) {
     if (world_rank == 0) {
       std::cout << "[Experimento " << (i + 1) << "/" << num_experiments << "]" << std::endl;
-      const auto serial_result = bow::run_serial(base_config);
-      serial_total += serial_result.average_time_ms;
-      std::cout << "  Serial promedio acumulado: " << serial_total / (i + 1) << " ms" << std::endl;
     }
 
-    // Sincronizamos todos los procesos antes de iniciar la corrida paralela.
-    MPI_Barrier(MPI_COMM_WORLD);
-    const auto parallel_result = bow::run_parallel(base_config);
-    if (world_rank == 0) {
-      parallel_total += parallel_result.average_time_ms;
-      std::cout << "  Paralelo promedio acumulado: " << parallel_total / (i + 1) << " ms"
-                << std::endl;
+    for (auto& entry : totals) {
+      const bow::Engine& engine = *entry.engine;
+      bow::ExperimentResult result;
+      if (engine.scope == bow::EngineScope::kAllRanks) {
+        // Sincronizamos todos los procesos antes de iniciar una corrida colectiva.
+        barrier_runtime();
+        result = engine.run(base_config);
+      } else if (world_rank == 0) {
+        result = engine.run(base_config);
+      }
+
+      if (world_rank == 0) {
+        entry.total_ms += result.average_time_ms;
+        bow::accumulate_phases(entry.phases, result.phases);
+        keep_max_per_rank(entry.peak_rss, result.peak_rss_bytes);
+        entry.io[0] += result.io_read_ms;
+        entry.io[1] += result.io_wait_ms;
+        entry.scheduler += result.scheduler;
+        std::cout << "  " << engine.name << " promedio acumulado: " << entry.total_ms / (i + 1)
+                  << " ms" << std::endl;
+      }
     }
   }
 
-  MPI_Finalize();
-
-  if (world_rank == 0) {
-    const double serial_avg = num_experiments > 0 ? serial_total / num_experiments : 0.0;
-    const double parallel_avg = num_experiments > 0 ? parallel_total / num_experiments : 0.0;
-    const double speedup = (parallel_avg > 0.0) ? (serial_avg / parallel_avg) : 0.0;
+  finalize_runtime();
 
+  if (world_rank == 0 && num_experiments > 0) {
     std::cout << "==== Resumen ====" << std::endl;
-    std::cout << "Tiempo promedio serial: " << serial_avg << " ms" << std::endl;
-    std::cout << "Tiempo promedio paralelo: " << parallel_avg << " ms" << std::endl;
-    std::cout << "Speed-up estimado: " << speedup << std::endl;
+    print_engine_comparison(totals, num_experiments);
+    for (const auto& entry : totals) {
+      const bool all_ranks = entry.engine->scope == bow::EngineScope::kAllRanks;
+      bow::print_phase_table(std::cout, entry.engine->name, entry.phases, num_experiments);
+      bow::print_peak_rss(std::cout, all_ranks ? entry.engine->name + " por rank"
+                                               : entry.engine->name,
+                          entry.peak_rss);
+      bow::print_scheduler_stats(std::cout, entry.engine->name, entry.scheduler, num_experiments);
+      if (base_config.prefetch_documents && base_config.stream_block_bytes == 0) {
+        print_hidden_io(all_ranks ? entry.engine->name + " (suma de ranks)" : entry.engine->name,
+                        entry.io, num_experiments);
+      }
+    }
   }
 
   return 0;
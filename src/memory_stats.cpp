@@ -0,0 +1,136 @@
+// memory_stats.cpp: Reemplazo de los operadores new/delete globales para contar asignaciones y
+// lectura del pico de memoria residente.
+#include "bow/memory_stats.hpp"
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+
+namespace {
+
+// Contadores relajados: solo se necesita el total, no un orden entre hilos.
+std::atomic<std::uint64_t> g_allocations{0};
+std::atomic<std::uint64_t> g_allocated_bytes{0};
+
+void* counted_allocate(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  void* pointer = std::malloc(size == 0 ? 1 : size);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* counted_allocate_nothrow(std::size_t size) noexcept {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+// Variante alineada (tipos con alignas mayor que el de malloc, como WorkStealingDeque).
+// aligned_alloc pide que el tamaño sea múltiplo de la alineación.
+void* counted_allocate_aligned(std::size_t size, std::align_val_t alignment) noexcept {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  const std::size_t align = static_cast<std::size_t>(alignment);
+  const std::size_t rounded = ((size == 0 ? 1 : size) + align - 1) / align * align;
+  return std::aligned_alloc(align, rounded);
+}
+
+void* counted_allocate_aligned_or_throw(std::size_t size, std::align_val_t alignment) {
+  void* pointer = counted_allocate_aligned(size, alignment);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) { return counted_allocate(size); }
+void* operator new[](std::size_t size) { return counted_allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return counted_allocate_nothrow(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return counted_allocate_nothrow(size);
+}
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+
+// Las alineadas también se cuentan: aligned_alloc se libera con free igual que malloc.
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return counted_allocate_aligned_or_throw(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return counted_allocate_aligned_or_throw(size, alignment);
+}
+void* operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  return counted_allocate_aligned(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  return counted_allocate_aligned(size, alignment);
+}
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+  std::free(pointer);
+}
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+  std::free(pointer);
+}
+
+namespace bow {
+
+AllocationStats allocation_snapshot() {
+  AllocationStats stats;
+  stats.allocations = g_allocations.load(std::memory_order_relaxed);
+  stats.bytes = g_allocated_bytes.load(std::memory_order_relaxed);
+  return stats;
+}
+
+std::uint64_t peak_rss_bytes() {
+  // VmHWM respeta el reinicio de clear_refs; ru_maxrss no, por eso es solo el respaldo.
+  std::ifstream status("/proc/self/status");
+  std::string key;
+  while (status >> key) {
+    if (key == "VmHWM:") {
+      std::uint64_t kilobytes = 0;
+      status >> kilobytes;
+      return kilobytes * 1024;
+    }
+    std::getline(status, key);
+  }
+
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;  // Linux reporta kB.
+  }
+  return 0;
+}
+
+void reset_peak_rss() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  if (clear_refs.is_open()) {
+    clear_refs << "5";  // 5 = reiniciar el pico de RSS.
+  }
+}
+
+}  // namespace bow
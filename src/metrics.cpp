@@ -0,0 +1,143 @@
+// metrics.cpp: Implementación del registro de fases y su impresión.
+#include "bow/metrics.hpp"
+
+#include <iomanip>
+
+namespace bow {
+
+double bytes_to_mib(std::uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+
+PhaseRecorder::PhaseRecorder(const std::vector<std::string>& phase_names, bool collect_counters) {
+  phases_.reserve(phase_names.size());
+  for (const auto& name : phase_names) {
+    phases_.push_back({name, 0.0, {}, 0, 0});
+  }
+  if (collect_counters) {
+    counters_ = std::make_unique<PerfCounterSet>();
+  }
+}
+
+void PhaseRecorder::begin(const std::string& phase) {
+  if (open_) {
+    end();  // Una fase nueva cierra implícitamente la anterior.
+  }
+
+  current_ = phases_.size();
+  for (std::size_t i = 0; i < phases_.size(); ++i) {
+    if (phases_[i].name == phase) {
+      current_ = i;
+      break;
+    }
+  }
+  if (current_ == phases_.size()) {
+    phases_.push_back({phase, 0.0, {}, 0, 0});
+  }
+
+  open_ = true;
+  if (trace_ != nullptr) {
+    trace_->begin(phase, "fase");
+  }
+  if (counters_) {
+    start_counters_ = counters_->read();
+  }
+  start_allocations_ = allocation_snapshot();
+  start_ = std::chrono::steady_clock::now();
+}
+
+void PhaseRecorder::end() {
+  if (!open_) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  PhaseMetrics& metrics = phases_[current_];
+  metrics.time_ms += std::chrono::duration<double, std::milli>(now - start_).count();
+  const AllocationStats allocations = allocation_snapshot();
+  metrics.allocations += allocations.allocations - start_allocations_.allocations;
+  metrics.allocated_bytes += allocations.bytes - start_allocations_.bytes;
+  if (counters_) {
+    metrics.counters += counters_->read() - start_counters_;
+  }
+  if (trace_ != nullptr) {
+    trace_->end();
+  }
+  open_ = false;
+}
+
+void accumulate_phases(std::vector<PhaseMetrics>& total, const std::vector<PhaseMetrics>& run) {
+  if (total.empty()) {
+    total = run;
+    return;
+  }
+  for (std::size_t i = 0; i < total.size() && i < run.size(); ++i) {
+    total[i].time_ms += run[i].time_ms;
+    total[i].counters += run[i].counters;
+    total[i].allocations += run[i].allocations;
+    total[i].allocated_bytes += run[i].allocated_bytes;
+  }
+}
+
+void print_phase_table(std::ostream& out, const std::string& title,
+                       const std::vector<PhaseMetrics>& total, int runs) {
+  if (total.empty() || runs <= 0) {
+    return;
+  }
+
+  out << "Fases " << title << " (promedio por corrida):" << std::endl;
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  for (const auto& phase : total) {
+    if (phase.time_ms == 0.0) {
+      continue;  // Fase declarada pero no usada en este modo (ej. lectura con --stream).
+    }
+    out << "  " << std::left << std::setw(24) << phase.name << std::right << std::setw(12)
+        << std::fixed << std::setprecision(3) << phase.time_ms / runs << " ms"
+        << "  allocs " << std::setw(9) << phase.allocations / runs << " ("
+        << std::setprecision(1) << bytes_to_mib(phase.allocated_bytes / runs) << " MiB)";
+    if (phase.counters.available) {
+      const HardwareCounters& c = phase.counters;
+      out << "  IPC " << std::setprecision(2) << instructions_per_cycle(c)
+          << "  ciclos " << c.cycles / runs << "  cache-miss " << c.cache_misses / runs
+          << "  branch-miss " << c.branch_misses / runs << "  dTLB-miss " << c.dtlb_misses / runs;
+    }
+    out << std::endl;
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void print_peak_rss(std::ostream& out, const std::string& title,
+                    const std::vector<std::uint64_t>& peak_by_rank) {
+  if (peak_by_rank.empty()) {
+    return;
+  }
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << "Memoria pico (RSS) " << title << ":" << std::fixed << std::setprecision(1);
+  if (peak_by_rank.size() == 1) {
+    out << " " << bytes_to_mib(peak_by_rank.front()) << " MiB";
+  } else {
+    for (std::size_t rank = 0; rank < peak_by_rank.size(); ++rank) {
+      out << " r" << rank << "=" << bytes_to_mib(peak_by_rank[rank]) << " MiB";
+    }
+  }
+  out << std::endl;
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void print_scheduler_stats(std::ostream& out, const std::string& title,
+                           const SchedulerStats& total, int runs) {
+  if (total.tasks == 0 || runs <= 0) {
+    return;
+  }
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << "Planificador " << title << " (promedio por corrida): " << total.tasks / runs
+      << " tareas, " << total.steals / runs << " robos, " << total.failed_steals / runs
+      << " robos fallidos, " << std::fixed << std::setprecision(3) << total.idle_ms / runs
+      << " ms ociosos" << std::endl;
+  out.flags(flags);
+  out.precision(precision);
+}
+
+}  // namespace bow
@@ -0,0 +1,38 @@
+// ngrams.cpp: Lectura del rango de n-gramas.
+#include "bow/ngrams.hpp"
+
+#include <cctype>
+
+namespace {
+
+// Número decimal sin signo que ocupa todo `text`; 0 si no lo es.
+std::size_t parse_length(const std::string& text) {
+  if (text.empty() || text.size() > 4) {
+    return 0;
+  }
+  std::size_t value = 0;
+  for (const char c : text) {
+    if (!std::isdigit(static_cast<unsigned char>(c))) {
+      return 0;
+    }
+    value = value * 10 + static_cast<std::size_t>(c - '0');
+  }
+  return value;
+}
+
+}  // namespace
+
+namespace bow {
+
+bool parse_ngram_range(const std::string& text, std::size_t longest, NgramRange& range) {
+  const std::size_t comma = text.find(',');
+  const std::size_t min = parse_length(text.substr(0, comma));
+  const std::size_t max = comma == std::string::npos ? min : parse_length(text.substr(comma + 1));
+  if (min == 0 || max < min || max > longest) {
+    return false;
+  }
+  range = {min, max};
+  return true;
+}
+
+}  // namespace bow
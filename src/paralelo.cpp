@@ -5,70 +5,38 @@
 
 #include <algorithm>
 #include <chrono>
-#include <cctype>
+#include <cstdlib>
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
-#include <map>
+#include <memory>
 #include <numeric>
-#include <set>
-#include <sstream>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
-namespace {
-
-// Abre un archivo completo y regresa su contenido como string.
-std::string read_file(const std::string& path) {
-  std::ifstream input(path);
-  if (!input.is_open()) {
-    std::cerr << "No se pudo abrir el archivo: " << path << std::endl;
-    return {};
-  }
-
-  std::ostringstream buffer;
-  buffer << input.rdbuf();
-  return buffer.str();
-}
-
-// Normaliza a minúsculas y separa tokens con cualquier carácter no alfanumérico.
-std::vector<std::string> tokenize_document(const std::string& content) {
-  std::vector<std::string> tokens;
-  std::string current_token;
+#include "bow/core.hpp"
+#include "bow/distributed_pruning.hpp"
+#include "bow/large_count.hpp"
+#include "bow/memory_stats.hpp"
+#include "bow/metrics.hpp"
+#include "bow/sample_sort.hpp"
+#include "bow/shared_vocab.hpp"
+#include "bow/tfidf.hpp"
+#include "bow/topology.hpp"
+#include "bow/trace.hpp"
 
-  for (unsigned char raw : content) {
-    const char lower = static_cast<char>(std::tolower(raw));
-    if (std::isalnum(lower) || lower == '_') {
-      current_token.push_back(lower);
-    } else {
-      if (!current_token.empty()) {
-        tokens.push_back(current_token);
-        current_token.clear();
-      }
-    }
-  }
-
-  if (!current_token.empty()) {
-    tokens.push_back(current_token);
-  }
-  return tokens;
-}
+namespace {
 
-// Cuenta cuántas veces aparece cada token dentro de un documento.
-std::map<std::string, int> count_tokens(const std::vector<std::string>& tokens) {
-  std::map<std::string, int> word_counts;
-  for (const auto& token : tokens) {
-    ++word_counts[token];
-  }
-  return word_counts;
-}
+// Tamaño aproximado de cada bloque del vocabulario difundido con MPI_Ibcast (--nonblocking).
+constexpr std::size_t kVocabularyBlockBytes = 64 * 1024;
 
-// Serializa un vocabulario (ordenado) separando cada palabra con '\n'.
-std::string join_words_with_newline(const std::set<std::string>& words) {
+// Serializa un vocabulario (ordenado y sin repetidos) separando cada palabra con '\n'.
+std::string join_words_with_newline(const std::vector<std::string_view>& words) {
   std::string serialized;
-  for (const auto& word : words) {
+  for (std::string_view word : words) {
     serialized += word;
     serialized.push_back('\n');
   }
@@ -95,236 +63,843 @@ std::vector<std::string> split_by_newline(const std::string& data) {
   return parts;
 }
 
-// Escribe la matriz final (ordenada por documento) en formato CSV.
-void write_csv(const std::vector<std::vector<int>>& matrix,
-               const std::vector<std::string>& vocabulary,
-               const std::vector<std::string>& doc_names,
-               const std::string& output_path) {
-  std::ofstream output(output_path);
-  if (!output.is_open()) {
-    std::cerr << "No se pudo abrir el CSV de salida: " << output_path << std::endl;
-    return;
+// Une vocabularios serializados (cada uno ordenado y terminado en '\n', posiblemente con
+// palabras repetidas entre ellos) en uno solo, ordenado y sin repetidos. Se ordenan vistas
+// sobre `text`: las palabras no se copian hasta serializarlas.
+std::string merge_vocabulary_text(const std::string& text) {
+  std::vector<std::string_view> words;
+  std::size_t start = 0;
+  for (std::size_t end = text.find('\n'); end != std::string::npos;
+       start = end + 1, end = text.find('\n', start)) {
+    if (end > start) {
+      words.emplace_back(text.data() + start, end - start);
+    }
   }
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+  return join_words_with_newline(words);
+}
 
-  output << "document";
-  for (const auto& word : vocabulary) {
-    output << ',' << word;
+// Reúne en el rank 0 de `comm` la concatenación, en orden de rank, de los buffers locales
+// (std::string o std::vector<int>); en los demás ranks regresa un buffer vacío. Los tamaños
+// viajan como enteros de 64 bits y la recolección admite más de 2^31 elementos (ver
+// gatherv_large).
+template <typename Buffer>
+Buffer gather_concatenated(const Buffer& local, MPI_Datatype type, MPI_Comm comm,
+                           bow::TraceRecorder& trace, const std::string& label,
+                           std::uint64_t max_message) {
+  int rank = 0;
+  int size = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Todos necesitan los tamaños para elegir la misma estrategia de recolección.
+  const std::uint64_t local_count = local.size();
+  std::vector<std::uint64_t> counts(size);
+  {
+    bow::TraceScope scope(trace, "MPI_Allgather tamaños " + label);
+    MPI_Allgather(&local_count, 1, MPI_UINT64_T, counts.data(), 1, MPI_UINT64_T, comm);
   }
-  output << '\n';
 
-  for (std::size_t i = 0; i < matrix.size(); ++i) {
-    output << doc_names[i];
-    for (int value : matrix[i]) {
-      output << ',' << value;
-    }
-    output << '\n';
+  Buffer gathered;
+  if (rank == 0) {
+    gathered.resize(std::accumulate(counts.begin(), counts.end(), std::uint64_t{0}));
+  }
+  {
+    bow::TraceScope scope(trace, "MPI_Gatherv " + label);
+    bow::gatherv_large(local.data(), type, rank == 0 ? gathered.data() : nullptr, counts, comm,
+                       max_message);
   }
+  return gathered;
 }
 
-}  // namespace
-
-namespace bow {
+// Difunde desde el rank 0 de `comm` un string (primero su tamaño, luego los bytes).
+void broadcast_buffer(std::string& data, MPI_Comm comm, bow::TraceRecorder& trace,
+                      const std::string& label, std::uint64_t max_message) {
+  std::uint64_t bytes = data.size();
+  {
+    bow::TraceScope scope(trace, "MPI_Bcast tamaño " + label);
+    MPI_Bcast(&bytes, 1, MPI_UINT64_T, 0, comm);
+  }
+  data.resize(bytes);
+  {
+    bow::TraceScope scope(trace, "MPI_Bcast " + label);
+    bow::bcast_large(data.data(), bytes, MPI_CHAR, comm, max_message);
+  }
+}
 
-// Ejecuta la versión MPI distribuyendo documentos y reuniendo resultados en rank 0.
-ExperimentResult run_parallel(const ExperimentConfig& config) {
-  ExperimentResult result;
-  if (config.document_paths.empty()) {
-    return result;
+// Combina las métricas por fase de todos los ranks en rank 0: el tiempo de cada fase es el
+// del rank más lento; contadores de hardware y asignaciones se suman.
+std::vector<bow::PhaseMetrics> reduce_phase_metrics(const std::vector<bow::PhaseMetrics>& local,
+                                                    int world_rank) {
+  constexpr std::size_t kFields = 7;  // 5 contadores de hardware + 2 de asignación.
+  const std::size_t phase_count = local.size();
+  std::vector<double> local_times(phase_count);
+  std::vector<std::uint64_t> local_counters(phase_count * kFields);
+  int local_available = 1;
+  for (std::size_t i = 0; i < phase_count; ++i) {
+    const bow::HardwareCounters& c = local[i].counters;
+    std::uint64_t* fields = &local_counters[i * kFields];
+    local_times[i] = local[i].time_ms;
+    fields[0] = c.cycles;
+    fields[1] = c.instructions;
+    fields[2] = c.cache_misses;
+    fields[3] = c.branch_misses;
+    fields[4] = c.dtlb_misses;
+    fields[5] = local[i].allocations;
+    fields[6] = local[i].allocated_bytes;
+    local_available = local_available && c.available;
   }
 
-  int world_rank = 0;
-  int world_size = 1;
-  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
-  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+  std::vector<double> max_times(phase_count);
+  std::vector<std::uint64_t> sum_counters(phase_count * kFields);
+  int all_available = 0;
+  MPI_Reduce(local_times.data(), max_times.data(), static_cast<int>(phase_count), MPI_DOUBLE,
+             MPI_MAX, 0, MPI_COMM_WORLD);
+  MPI_Reduce(local_counters.data(), sum_counters.data(), static_cast<int>(phase_count * kFields),
+             MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  // Si algún rank no pudo abrir sus contadores la suma no es comparable: se marcan como no
+  // disponibles.
+  MPI_Reduce(&local_available, &all_available, 1, MPI_INT, MPI_MIN, 0, MPI_COMM_WORLD);
+
+  std::vector<bow::PhaseMetrics> reduced;
+  if (world_rank != 0) {
+    return reduced;
+  }
+  reduced = local;
+  for (std::size_t i = 0; i < phase_count; ++i) {
+    bow::HardwareCounters& c = reduced[i].counters;
+    const std::uint64_t* fields = &sum_counters[i * kFields];
+    reduced[i].time_ms = max_times[i];
+    c.cycles = fields[0];
+    c.instructions = fields[1];
+    c.cache_misses = fields[2];
+    c.branch_misses = fields[3];
+    c.dtlb_misses = fields[4];
+    c.available = all_available != 0;
+    reduced[i].allocations = fields[5];
+    reduced[i].allocated_bytes = fields[6];
+  }
+  return reduced;
+}
 
-  const auto start_time = std::chrono::steady_clock::now();
+// Reúne en rank 0 el pico de RSS de cada rank.
+std::vector<std::uint64_t> gather_peak_rss(int world_rank, int world_size) {
+  const std::uint64_t local_peak = bow::peak_rss_bytes();
+  std::vector<std::uint64_t> peaks;
+  if (world_rank == 0) {
+    peaks.resize(world_size);
+  }
+  MPI_Gather(&local_peak, 1, MPI_UINT64_T, world_rank == 0 ? peaks.data() : nullptr, 1,
+             MPI_UINT64_T, 0, MPI_COMM_WORLD);
+  return peaks;
+}
 
-  std::vector<std::map<std::string, int>> local_counts;
-  std::vector<int> local_doc_indices;
-  local_counts.reserve((config.document_paths.size() + world_size - 1) / world_size);
+// Lo que rank 0 necesita para escribir el CSV: el vocabulario global y las filas densas
+// (planas, vocabulary.size() celdas por fila) con el índice original de cada documento. Las
+// celdas son conteos (int) o, con --tfidf, pesos (float).
+template <typename Cell>
+struct GatheredRows {
+  std::vector<std::string> vocabulary;
+  std::vector<int> doc_indices;
+  std::vector<Cell> values;
+};
+
+// Tipo MPI de las celdas de una fila.
+template <typename Cell>
+MPI_Datatype cell_datatype() {
+  return std::is_same_v<Cell, float> ? MPI_FLOAT : MPI_INT;
+}
 
-  for (std::size_t idx = world_rank; idx < config.document_paths.size(); idx += world_size) {
-    const std::string& path = config.document_paths[idx];
-    const std::string content = read_file(path);
-    if (content.empty()) {
-      continue;
+// Estado de la corrida que comparten las dos variantes del intercambio.
+struct ExchangeContext {
+  const bow::ExperimentConfig& config;
+  bow::PhaseRecorder& recorder;
+  bow::TraceRecorder& trace;
+  const bow::NodeTopology* topology;  // nullptr sin --hierarchical ni --shared-vocab.
+  int world_rank;
+};
+
+// Vocabulario local de un rank: sus símbolos distintos, ordenados por palabra, y su
+// serialización (cada palabra una sola vez por rank, terminada en '\n').
+struct LocalVocabulary {
+  const bow::SymbolTable& symbols;
+  std::vector<bow::SymbolId> sorted;
+  std::string serialized;
+};
+
+// Vocabulario global ya distribuido: en la ventana compartida del nodo (--shared-vocab), como
+// copia propia, o (--sample-sort) solo el rango de este rank. Con --shared-vocab o
+// --sample-sort, `words` solo existe en rank 0. En todos los casos cada símbolo local se
+// resuelve a su columna una sola vez, así armar filas no vuelve a tocar palabras.
+struct DistributedVocabulary {
+  std::unique_ptr<bow::SharedVocabulary> shared;
+  std::vector<std::string> words;
+  std::vector<int> column_of_symbol;  // Columna global de cada símbolo local (-1 si no está).
+  int columns = 0;
+  std::vector<double> idf;  // Solo con --tfidf: idf global de cada columna.
+  bool sublinear_tf = false;
+  std::vector<std::pair<int, double>> scratch;  // Pesos de la fila en curso (weight_row).
+
+  int size() const { return shared ? shared->size() : columns; }
+
+  // Escribe en `row` (de tamaño size()) los conteos de un documento en espacio de columnas.
+  void fill_row(const bow::WordCounts& document_map, int* row) const {
+    for (const auto& entry : document_map) {
+      const int column = column_of_symbol[entry.first];
+      if (column >= 0) {
+        row[column] = entry.second;
+      }
     }
+  }
 
-    const std::vector<std::string> tokens = tokenize_document(content);
-    local_counts.push_back(count_tokens(tokens));
-    local_doc_indices.push_back(static_cast<int>(idx));
+  // Igual, con los pesos TF-IDF del documento.
+  void fill_row(const bow::WordCounts& document_map, float* row) {
+    bow::weight_row(document_map, column_of_symbol, idf, sublinear_tf, row, scratch);
   }
+};
+
+// Columnas de la matriz densa para un vocabulario global de `words` palabras. Filas planas y
+// column_of_symbol indexan columnas con int, y una fila de más de 2^31 celdas tampoco cabría
+// en memoria, así que en vez de truncar se detiene la corrida. Todos los ranks llaman con el
+// mismo total, así que todos llegan aquí juntos.
+int checked_column_count(std::uint64_t words, int world_rank) {
+  if (words > bow::kMaxMessageElements) {
+    std::cerr << "MPI (rank " << world_rank << "): el vocabulario global tiene " << words
+              << " palabras y la matriz densa admite a lo más " << bow::kMaxMessageElements
+              << " columnas; usa --max-features o --min-df para podarlo." << std::endl;
+    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+  }
+  return static_cast<int>(words);
+}
 
-  std::set<std::string> local_vocab;
-  for (const auto& doc_map : local_counts) {
-    for (const auto& entry : doc_map) {
-      local_vocab.insert(entry.first);
-    }
+// Con --tfidf, idf global de cada columna: cada rank cuenta en cuántos de sus documentos
+// aparece cada columna y un MPI_Allreduce suma esos arreglos (y el número de documentos).
+// Así cada rank pondera sus propias filas sin reunir conteos en ningún lado.
+void reduce_inverse_document_frequency(const ExchangeContext& context,
+                                       const std::vector<bow::WordCounts>& local_counts,
+                                       DistributedVocabulary& vocabulary) {
+  context.recorder.begin("idf");
+  std::vector<std::uint64_t> frequency = bow::column_document_frequency(
+      local_counts, vocabulary.column_of_symbol, static_cast<std::size_t>(vocabulary.size()));
+  std::uint64_t documents = local_counts.size();
+  {
+    bow::TraceScope scope(context.trace, "MPI_Allreduce frecuencias de documento");
+    MPI_Allreduce(MPI_IN_PLACE, &documents, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+    bow::allreduce_large(frequency.data(), frequency.size(), MPI_UINT64_T, MPI_SUM,
+                         MPI_COMM_WORLD, context.config.max_message_elements);
   }
+  vocabulary.idf =
+      bow::inverse_document_frequency(frequency, documents, context.config.tfidf.smooth_idf);
+  vocabulary.sublinear_tf = context.config.tfidf.sublinear_tf;
+}
 
-  const std::string local_vocab_serialized = join_words_with_newline(local_vocab);
-  const int local_vocab_bytes = static_cast<int>(local_vocab_serialized.size());
+// Reúne vocabularios en rank 0 y difunde el global (plano, jerárquico o en ventana
+// compartida) con colectivas bloqueantes.
+DistributedVocabulary distribute_vocabulary(const ExchangeContext& context,
+                                            const LocalVocabulary& local) {
+  const std::string& local_vocab_serialized = local.serialized;
+  const bool hierarchical = context.config.hierarchical_collectives;
+  const std::uint64_t max_message = context.config.max_message_elements;
+  const bow::NodeTopology* topology = context.topology;
+  bow::PhaseRecorder& recorder = context.recorder;
+  bow::TraceRecorder& trace = context.trace;
+
+  recorder.begin("intercambio_vocabulario");
+  DistributedVocabulary vocabulary;
+  if (context.config.sample_sort_vocabulary) {
+    // Ningún rank arma el vocabulario completo salvo rank 0, y solo para los encabezados: los
+    // rangos ordenados de cada rank, concatenados en orden de rank, ya son el vocabulario.
+    const bow::SortedVocabularyRange range =
+        bow::sample_sort_vocabulary(local_vocab_serialized, MPI_COMM_WORLD, trace, max_message);
+    const std::string sorted_text = gather_concatenated(range.owned, MPI_CHAR, MPI_COMM_WORLD,
+                                                        trace, "vocabulario ordenado",
+                                                        max_message);
+    if (context.world_rank == 0) {
+      vocabulary.words = split_by_newline(sorted_text);
+    }
+    recorder.begin("indice_vocabulario");
+    vocabulary.columns = checked_column_count(range.total_words, context.world_rank);
+    vocabulary.column_of_symbol.assign(local.symbols.size(), -1);
+    for (std::size_t i = 0; i < local.sorted.size(); ++i) {
+      vocabulary.column_of_symbol[local.sorted[i]] = static_cast<int>(range.local_columns[i]);
+    }
+    return vocabulary;
+  }
 
-  std::vector<int> vocab_byte_counts;
-  if (world_rank == 0) {
-    vocab_byte_counts.resize(world_size);
+  std::string vocab_text;  // En rank 0: vocabularios (ya unidos por nodo si es jerárquico).
+  if (hierarchical) {
+    const std::string node_text =
+        gather_concatenated(local_vocab_serialized, MPI_CHAR, topology->node_comm(), trace,
+                            "vocabulario (nodo)", max_message);
+    if (topology->is_leader()) {
+      vocab_text = gather_concatenated(merge_vocabulary_text(node_text), MPI_CHAR,
+                                       topology->leader_comm(), trace, "vocabulario (líderes)",
+                                       max_message);
+    }
+  } else {
+    vocab_text = gather_concatenated(local_vocab_serialized, MPI_CHAR, MPI_COMM_WORLD, trace,
+                                     "vocabulario", max_message);
+  }
+  std::string broadcast_vocab;
+  if (context.world_rank == 0) {
+    broadcast_vocab = merge_vocabulary_text(vocab_text);
   }
-  MPI_Gather(&local_vocab_bytes, 1, MPI_INT,
-             world_rank == 0 ? vocab_byte_counts.data() : nullptr, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
-  std::vector<int> vocab_displs;
-  std::vector<char> global_vocab_buffer;
-  if (world_rank == 0) {
-    vocab_displs.resize(world_size);
-    int total = 0;
-    for (int i = 0; i < world_size; ++i) {
-      vocab_displs[i] = total;  // Offset dentro del buffer concatenado.
-      total += vocab_byte_counts[i];  // Sumamos los bytes aportados por cada rank.
+  // Con --shared-vocab cada nodo guarda una sola copia del vocabulario y de su índice; si no,
+  // cada rank recibe el vocabulario completo.
+  if (context.config.shared_vocabulary) {
+    // La ventana guarda columnas int32: se revisa el total en todos los ranks antes de
+    // armarla, como en los demás caminos, en vez de truncarlo ahí adentro.
+    std::uint64_t word_count = 0;
+    if (context.world_rank == 0) {
+      word_count = static_cast<std::uint64_t>(
+          std::count(broadcast_vocab.begin(), broadcast_vocab.end(), '\n'));
+    }
+    {
+      bow::TraceScope scope(trace, "MPI_Bcast tamaño vocabulario");
+      MPI_Bcast(&word_count, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
     }
-    global_vocab_buffer.resize(total);
+    vocabulary.columns = checked_column_count(word_count, context.world_rank);
+    vocabulary.shared = std::make_unique<bow::SharedVocabulary>(broadcast_vocab, *topology,
+                                                                trace, max_message);
+    if (context.world_rank == 0) {
+      vocabulary.words = split_by_newline(broadcast_vocab);  // Solo para los encabezados.
+    }
+  } else {
+    if (!hierarchical) {
+      broadcast_buffer(broadcast_vocab, MPI_COMM_WORLD, trace, "vocabulario", max_message);
+    } else {
+      if (topology->is_leader()) {
+        broadcast_buffer(broadcast_vocab, topology->leader_comm(), trace, "vocabulario (líderes)",
+                         max_message);
+      }
+      broadcast_buffer(broadcast_vocab, topology->node_comm(), trace, "vocabulario (nodo)",
+                       max_message);
+    }
+    vocabulary.words = split_by_newline(broadcast_vocab);
+    vocabulary.columns = checked_column_count(vocabulary.words.size(), context.world_rank);
   }
 
-  MPI_Gatherv(local_vocab_serialized.data(), local_vocab_bytes, MPI_CHAR,
-              world_rank == 0 ? global_vocab_buffer.data() : nullptr,
-              world_rank == 0 ? vocab_byte_counts.data() : nullptr,
-              world_rank == 0 ? vocab_displs.data() : nullptr, MPI_CHAR, 0, MPI_COMM_WORLD);
+  // El vocabulario global y el local están ordenados: sin --shared-vocab basta un recorrido
+  // conjunto de ambos, sin tabla hash.
+  recorder.begin("indice_vocabulario");
+  vocabulary.column_of_symbol.assign(local.symbols.size(), -1);
+  std::size_t column = 0;
+  for (bow::SymbolId id : local.sorted) {
+    const std::string_view word = local.symbols.word(id);
+    if (vocabulary.shared) {
+      vocabulary.column_of_symbol[id] = vocabulary.shared->find(word);
+      continue;
+    }
+    while (column < vocabulary.words.size() && vocabulary.words[column] < word) {
+      ++column;
+    }
+    if (column < vocabulary.words.size() && vocabulary.words[column] == word) {
+      vocabulary.column_of_symbol[id] = static_cast<int>(column);
+    }
+  }
+  return vocabulary;
+}
 
-  std::string broadcast_vocab;
-  if (world_rank == 0) {
-    std::set<std::string> global_vocab_set;
-    for (int i = 0; i < world_size; ++i) {
-      const int offset = vocab_displs[i];
-      const int length = vocab_byte_counts[i];
-      if (length == 0) {
-        continue;
-      }
-      std::string chunk(global_vocab_buffer.begin() + offset,
-                        global_vocab_buffer.begin() + offset + length);
-      const auto words = split_by_newline(chunk);
-      global_vocab_set.insert(words.begin(), words.end());
+// Intercambio con colectivas bloqueantes: distribuye el vocabulario global, arma las filas y
+// las reúne en rank 0.
+template <typename Cell>
+GatheredRows<Cell> exchange_blocking(const ExchangeContext& context,
+                               const std::vector<bow::WordCounts>& local_counts,
+                               const LocalVocabulary& local,
+                               const std::vector<int>& local_doc_indices) {
+  const bool hierarchical = context.config.hierarchical_collectives;
+  const std::uint64_t max_message = context.config.max_message_elements;
+  const bow::NodeTopology* topology = context.topology;
+  bow::PhaseRecorder& recorder = context.recorder;
+  bow::TraceRecorder& trace = context.trace;
+  const auto gather_to_root = [&](const auto& local, MPI_Datatype type, const std::string& label) {
+    using Buffer = std::decay_t<decltype(local)>;
+    if (!hierarchical) {
+      return gather_concatenated(local, type, MPI_COMM_WORLD, trace, label, max_message);
     }
-    for (const auto& word : global_vocab_set) {
-      broadcast_vocab += word;
-      broadcast_vocab.push_back('\n');
+    const Buffer node = gather_concatenated(local, type, topology->node_comm(), trace,
+                                            label + " (nodo)", max_message);
+    if (!topology->is_leader()) {
+      return Buffer{};
     }
+    return gather_concatenated(node, type, topology->leader_comm(), trace, label + " (líderes)",
+                               max_message);
+  };
+
+  DistributedVocabulary vocabulary = distribute_vocabulary(context, local);
+  const int vocab_size = vocabulary.size();
+  if constexpr (std::is_same_v<Cell, float>) {
+    reduce_inverse_document_frequency(context, local_counts, vocabulary);
   }
 
-  int vocab_bytes = static_cast<int>(broadcast_vocab.size());
-  MPI_Bcast(&vocab_bytes, 1, MPI_INT, 0, MPI_COMM_WORLD);
-  if (world_rank != 0) {
-    broadcast_vocab.resize(vocab_bytes);
+  recorder.begin("filas");
+  std::vector<Cell> local_rows_flat(local_counts.size() * static_cast<std::size_t>(vocab_size),
+                                    Cell{});
+  for (std::size_t i = 0; i < local_counts.size(); ++i) {
+    vocabulary.fill_row(local_counts[i], local_rows_flat.data() + i * vocab_size);
   }
-  MPI_Bcast(!broadcast_vocab.empty() ? broadcast_vocab.data() : nullptr, vocab_bytes, MPI_CHAR, 0,
-            MPI_COMM_WORLD);
-  const std::vector<std::string> global_vocabulary = split_by_newline(broadcast_vocab);
 
-  const int vocab_size = static_cast<int>(global_vocabulary.size());
-  std::unordered_map<std::string, int> vocab_index;
-  vocab_index.reserve(global_vocabulary.size());
-  for (int i = 0; i < vocab_size; ++i) {
-    vocab_index.emplace(global_vocabulary[i], i);
+  // Índices y filas se reúnen con el mismo orden de ranks, así la fila i corresponde al
+  // documento rows.doc_indices[i].
+  recorder.begin("recoleccion");
+  GatheredRows<Cell> rows;
+  rows.vocabulary = std::move(vocabulary.words);
+  rows.doc_indices = gather_to_root(local_doc_indices, MPI_INT, "índices de documento");
+  rows.values = gather_to_root(local_rows_flat, cell_datatype<Cell>(), "filas");
+  return rows;
+}
+
+// Variante con colectivas no bloqueantes (--nonblocking, solo en el esquema plano):
+// 1. Un MPI_Allgather reparte {bytes de vocabulario, filas} de cada rank y enseguida se publican
+//    dos MPI_Igatherv, vocabulario e índices de documento; rank 0 une los vocabularios
+//    mientras los índices siguen en tránsito.
+// 2. rank 0 difunde el vocabulario en bloques de ~kVocabularyBlockBytes con un MPI_Ibcast por
+//    bloque. Cada rank pasa sus conteos a columnas con el bloque k (el vocabulario y cada
+//    conteo están ordenados, así basta avanzar un cursor por documento) mientras los bloques
+//    siguientes aún viajan.
+// 3. Las filas se reúnen con MPI_Igatherv y solo al final se espera a ambas recolecciones.
+template <typename Cell>
+GatheredRows<Cell> exchange_nonblocking(const ExchangeContext& context,
+                                  const std::vector<bow::WordCounts>& local_counts,
+                                  const LocalVocabulary& local,
+                                  const std::vector<int>& local_doc_indices) {
+  const std::string& local_vocab_serialized = local.serialized;
+  bow::PhaseRecorder& recorder = context.recorder;
+  bow::TraceRecorder& trace = context.trace;
+  const bool root = context.world_rank == 0;
+  int world_size = 1;
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+  GatheredRows<Cell> rows;
+
+  recorder.begin("intercambio_vocabulario");
+  const std::uint64_t max_message = context.config.max_message_elements;
+  const std::uint64_t local_sizes[2] = {local_vocab_serialized.size(), local_counts.size()};
+  std::vector<std::uint64_t> sizes(2 * static_cast<std::size_t>(world_size));
+  {
+    bow::TraceScope scope(trace, "MPI_Allgather tamaños vocabulario y filas");
+    MPI_Allgather(local_sizes, 2, MPI_UINT64_T, sizes.data(), 2, MPI_UINT64_T, MPI_COMM_WORLD);
+  }
+  std::vector<std::uint64_t> vocab_counts(world_size);
+  std::vector<std::uint64_t> row_counts(world_size);
+  for (int i = 0; i < world_size; ++i) {
+    vocab_counts[i] = sizes[2 * i];
+    row_counts[i] = sizes[2 * i + 1];
   }
 
-  const int local_row_count = static_cast<int>(local_counts.size());
-  std::vector<int> row_counts;
-  if (world_rank == 0) {
-    row_counts.resize(world_size);
+  std::string vocab_text;
+  if (root) {
+    vocab_text.resize(std::accumulate(vocab_counts.begin(), vocab_counts.end(), std::uint64_t{0}));
+    rows.doc_indices.resize(
+        std::accumulate(row_counts.begin(), row_counts.end(), std::uint64_t{0}));
   }
-  MPI_Gather(&local_row_count, 1, MPI_INT, world_rank == 0 ? row_counts.data() : nullptr, 1,
-             MPI_INT, 0, MPI_COMM_WORLD);
 
-  std::vector<int> local_rows_flat;
-  local_rows_flat.reserve(static_cast<std::size_t>(local_row_count) * vocab_size);
-  for (const auto& document_map : local_counts) {
-    std::vector<int> row(vocab_size, 0);
-    for (const auto& entry : document_map) {
-      const auto lookup = vocab_index.find(entry.first);
-      if (lookup != vocab_index.end()) {
-        row[lookup->second] = entry.second;
+  bow::PendingGather vocab_gather;
+  bow::PendingGather indices_gather;
+  {
+    bow::TraceScope scope(trace, "MPI_Igatherv vocabulario");
+    vocab_gather = bow::igatherv_large(local_vocab_serialized.data(), MPI_CHAR,
+                                       root ? vocab_text.data() : nullptr, vocab_counts,
+                                       MPI_COMM_WORLD, max_message);
+  }
+  {
+    bow::TraceScope scope(trace, "MPI_Igatherv índices de documento");
+    indices_gather = bow::igatherv_large(local_doc_indices.data(), MPI_INT,
+                                         root ? rows.doc_indices.data() : nullptr, row_counts,
+                                         MPI_COMM_WORLD, max_message);
+  }
+  {
+    bow::TraceScope scope(trace, "MPI_Wait vocabulario");
+    vocab_gather.wait();
+  }
+
+  // rank 0 corta el vocabulario unido en bloques que terminan en fin de palabra.
+  std::string vocab_buffer;
+  std::vector<int> block_bytes;
+  std::uint64_t header[2] = {0, 0};  // {bloques, palabras}.
+  if (root) {
+    const std::size_t block_limit = std::min<std::uint64_t>(kVocabularyBlockBytes, max_message);
+    vocab_buffer = merge_vocabulary_text(vocab_text);
+    std::string().swap(vocab_text);
+    std::size_t block_start = 0;
+    for (std::size_t i = 0; i < vocab_buffer.size(); ++i) {
+      if (vocab_buffer[i] != '\n') {
+        continue;
+      }
+      ++header[1];
+      if (i + 1 - block_start >= block_limit || i + 1 == vocab_buffer.size()) {
+        block_bytes.push_back(static_cast<int>(i + 1 - block_start));
+        block_start = i + 1;
       }
     }
-    local_rows_flat.insert(local_rows_flat.end(), row.begin(), row.end());
+    header[0] = block_bytes.size();
+  }
+  {
+    bow::TraceScope scope(trace, "MPI_Bcast bloques de vocabulario");
+    MPI_Bcast(header, 2, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+    block_bytes.resize(header[0]);
+    bow::bcast_large(block_bytes.data(), header[0], MPI_INT, MPI_COMM_WORLD, max_message);
   }
 
-  std::vector<int> doc_index_displs;
-  std::vector<int> gathered_doc_indices;
-  if (world_rank == 0) {
-    doc_index_displs.resize(world_size);
-    int running = 0;
-    for (int i = 0; i < world_size; ++i) {
-      doc_index_displs[i] = running;  // Posición donde inicia el bloque del proceso i.
-      running += row_counts[i];
+  std::vector<std::size_t> block_offsets(block_bytes.size());
+  std::size_t total_bytes = 0;
+  for (std::size_t k = 0; k < block_bytes.size(); ++k) {
+    block_offsets[k] = total_bytes;
+    total_bytes += block_bytes[k];
+  }
+  vocab_buffer.resize(total_bytes);
+  std::vector<MPI_Request> block_requests(block_bytes.size(), MPI_REQUEST_NULL);
+  {
+    bow::TraceScope scope(trace, "MPI_Ibcast vocabulario");
+    for (std::size_t k = 0; k < block_bytes.size(); ++k) {
+      MPI_Ibcast(vocab_buffer.data() + block_offsets[k], block_bytes[k], MPI_CHAR, 0,
+                 MPI_COMM_WORLD, &block_requests[k]);
     }
-    gathered_doc_indices.resize(running);
   }
 
-  MPI_Gatherv(local_doc_indices.data(), local_row_count, MPI_INT,
-              world_rank == 0 ? gathered_doc_indices.data() : nullptr,
-              world_rank == 0 ? row_counts.data() : nullptr,
-              world_rank == 0 ? doc_index_displs.data() : nullptr, MPI_INT, 0, MPI_COMM_WORLD);
+  recorder.begin("filas");
+  DistributedVocabulary vocabulary;  // Solo el índice local: las palabras quedan en rows.
+  vocabulary.columns = checked_column_count(header[1], context.world_rank);
+  const std::size_t vocab_size = static_cast<std::size_t>(vocabulary.columns);
+  rows.vocabulary.reserve(vocab_size);
+  std::vector<int>& column_of_symbol = vocabulary.column_of_symbol;
+  column_of_symbol.assign(local.symbols.size(), -1);
+  auto cursor = local.sorted.begin();
+
+  for (std::size_t k = 0; k < block_bytes.size(); ++k) {
+    {
+      bow::TraceScope scope(trace, "MPI_Wait bloque de vocabulario");
+      MPI_Wait(&block_requests[k], MPI_STATUS_IGNORE);
+    }
+    const std::size_t first_column = rows.vocabulary.size();
+    const std::vector<std::string> block_words =
+        split_by_newline(vocab_buffer.substr(block_offsets[k], block_bytes[k]));
+    rows.vocabulary.insert(rows.vocabulary.end(), block_words.begin(), block_words.end());
+    if (block_words.empty()) {
+      continue;
+    }
 
-  const int local_value_count = vocab_size * local_row_count;
-  std::vector<int> value_counts;
-  std::vector<int> value_displs;
-  std::vector<int> gathered_values;
-  if (world_rank == 0) {
-    value_counts.resize(world_size);
-    value_displs.resize(world_size);
-    int running = 0;
-    for (int i = 0; i < world_size; ++i) {
-      value_counts[i] = row_counts[i] * vocab_size;  // Número de enteros que envía cada proceso.
-      value_displs[i] = running;                     // Offset dentro del buffer plano.
-      running += value_counts[i];
+    while (cursor != local.sorted.end() && local.symbols.word(*cursor) <= block_words.back()) {
+      const std::string_view word = local.symbols.word(*cursor);
+      const auto found = std::lower_bound(block_words.begin(), block_words.end(), word);
+      if (found != block_words.end() && *found == word) {
+        column_of_symbol[*cursor] = static_cast<int>(first_column + (found - block_words.begin()));
+      }
+      ++cursor;
     }
-    gathered_values.resize(running);
   }
 
-  MPI_Gatherv(local_rows_flat.data(), local_value_count, MPI_INT,
-              world_rank == 0 ? gathered_values.data() : nullptr,
-              world_rank == 0 ? value_counts.data() : nullptr,
-              world_rank == 0 ? value_displs.data() : nullptr, MPI_INT, 0, MPI_COMM_WORLD);
+  if constexpr (std::is_same_v<Cell, float>) {
+    // Colectiva bloqueante con las recolecciones aún en curso: MPI solo pide que todos los
+    // ranks las inicien en el mismo orden.
+    reduce_inverse_document_frequency(context, local_counts, vocabulary);
+    recorder.begin("filas");
+  }
+  std::vector<Cell> local_rows_flat(local_counts.size() * vocab_size, Cell{});
+  for (std::size_t d = 0; d < local_counts.size(); ++d) {
+    vocabulary.fill_row(local_counts[d], local_rows_flat.data() + d * vocab_size);
+  }
 
-  if (world_rank == 0) {
-    const int total_rows =
-        std::accumulate(row_counts.begin(), row_counts.end(), 0,
-                        std::plus<int>());  // Total de documentos recibidos.
-    std::vector<std::pair<int, std::vector<int>>> ordered_rows;
-    ordered_rows.reserve(total_rows);
-
-    std::size_t offset = 0;
-    for (int i = 0; i < total_rows; ++i) {
-      std::vector<int> row(vocab_size, 0);
-      if (vocab_size > 0) {
-        std::copy(gathered_values.begin() + offset, gathered_values.begin() + offset + vocab_size,
-                  row.begin());
-      }
-      ordered_rows.push_back({gathered_doc_indices[i], std::move(row)});
-      offset += vocab_size;
-    }
-    std::sort(ordered_rows.begin(), ordered_rows.end(),
-              [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+  recorder.begin("recoleccion");
+  std::vector<std::uint64_t> value_counts(world_size);
+  for (int i = 0; i < world_size; ++i) {
+    value_counts[i] = row_counts[i] * vocab_size;
+  }
+  if (root) {
+    rows.values.resize(rows.doc_indices.size() * vocab_size);
+  }
+  bow::PendingGather rows_gather;
+  {
+    bow::TraceScope scope(trace, "MPI_Igatherv filas");
+    rows_gather = bow::igatherv_large(local_rows_flat.data(), cell_datatype<Cell>(),
+                                      root ? rows.values.data() : nullptr, value_counts,
+                                      MPI_COMM_WORLD, max_message);
+  }
+  {
+    bow::TraceScope scope(trace, "MPI_Wait filas e índices");
+    indices_gather.wait();
+    rows_gather.wait();
+  }
+  return rows;
+}
 
-    std::vector<std::string> doc_names;
-    std::vector<std::vector<int>> matrix;
-    doc_names.reserve(ordered_rows.size());
-    matrix.reserve(ordered_rows.size());
+// Variante por lotes (--stream-gather): en vez de reunir la matriz completa en rank 0, los
+// documentos se recorren en lotes de config.gather_batch_documents índices consecutivos. En
+// cada lote cada rank arma solo las filas de sus documentos y rank 0 las recibe con un
+// MPI_Igatherv y las escribe de inmediato en el CSV. El lote k + 1 se arma y se publica
+// mientras rank 0 escribe el k, así rank 0 guarda a lo más dos lotes de filas.
+template <typename Cell>
+void stream_rows_to_root(const ExchangeContext& context, int world_size,
+                         const std::vector<bow::WordCounts>& local_counts,
+                         const LocalVocabulary& local,
+                         const std::vector<int>& local_doc_indices) {
+  const bow::ExperimentConfig& config = context.config;
+  bow::PhaseRecorder& recorder = context.recorder;
+  bow::TraceRecorder& trace = context.trace;
+  const bool root = context.world_rank == 0;
+
+  DistributedVocabulary vocabulary = distribute_vocabulary(context, local);
+  const std::size_t vocab_size = static_cast<std::size_t>(vocabulary.size());
+  if constexpr (std::is_same_v<Cell, float>) {
+    reduce_inverse_document_frequency(context, local_counts, vocabulary);
+  }
 
-    for (const auto& row : ordered_rows) {
-      doc_names.push_back(std::filesystem::path(config.document_paths[row.first]).filename().string());
-      matrix.push_back(row.second);
-    }
+  // Todos los ranks necesitan saber qué documentos se procesaron para acordar los tamaños de
+  // cada lote (son índices, no filas: O(documentos) enteros).
+  recorder.begin("filas_por_lotes");
+  const int local_rows = static_cast<int>(local_doc_indices.size());
+  std::vector<int> rows_per_rank(world_size, 0);
+  {
+    bow::TraceScope scope(trace, "MPI_Allgather filas por rank");
+    MPI_Allgather(&local_rows, 1, MPI_INT, rows_per_rank.data(), 1, MPI_INT, MPI_COMM_WORLD);
+  }
+  std::vector<int> index_displs(world_size, 0);
+  std::partial_sum(rows_per_rank.begin(), rows_per_rank.end() - 1, index_displs.begin() + 1);
+  std::vector<int> processed(index_displs.back() + rows_per_rank.back());
+  {
+    bow::TraceScope scope(trace, "MPI_Allgatherv índices de documento");
+    MPI_Allgatherv(local_doc_indices.data(), local_rows, MPI_INT, processed.data(),
+                   rows_per_rank.data(), index_displs.data(), MPI_INT, MPI_COMM_WORLD);
+  }
+  std::sort(processed.begin(), processed.end());
 
-    if (!doc_names.empty()) {
+  std::unique_ptr<bow::CsvWriter> writer;
+  if (root) {
+    if (!processed.empty()) {
       const std::filesystem::path output_file = std::filesystem::path("results") / "bow_mpi.csv";
       std::filesystem::create_directories(output_file.parent_path());
-      write_csv(matrix, global_vocabulary, doc_names, output_file.string());
+      writer = std::make_unique<bow::CsvWriter>(output_file.string(), vocabulary.words);
     } else {
       std::cerr << "MPI: No se generaron filas, revisar entradas." << std::endl;
     }
   }
 
+  struct Batch {
+    std::vector<int> documents;       // Índices procesados del lote, en orden de documento.
+    std::vector<std::uint64_t> counts;  // Valores (filas * vocabulario) que aporta cada rank.
+    std::vector<Cell> send;
+    std::vector<Cell> received;       // Solo en rank 0.
+    bow::PendingGather pending;
+  };
+  Batch slots[2];
+  const std::size_t total_documents = config.document_paths.size();
+  const std::size_t batch_documents = config.gather_batch_documents;
+  const std::size_t batches = (total_documents + batch_documents - 1) / batch_documents;
+  std::size_t local_cursor = 0;
+  std::size_t global_cursor = 0;
+
+  // Los documentos se asignaron en round-robin, así el dueño del documento d es d % world_size
+  // y cada rank aporta sus filas del lote en orden creciente de documento.
+  const auto post_batch = [&](std::size_t batch_index, Batch& batch) {
+    const int limit = static_cast<int>(std::min(total_documents,
+                                                (batch_index + 1) * batch_documents));
+    batch.send.clear();
+    while (local_cursor < local_counts.size() && local_doc_indices[local_cursor] < limit) {
+      batch.send.resize(batch.send.size() + vocab_size, Cell{});
+      vocabulary.fill_row(local_counts[local_cursor], batch.send.data() + batch.send.size() -
+                                                          vocab_size);
+      ++local_cursor;
+    }
+    batch.documents.clear();
+    batch.counts.assign(world_size, 0);
+    while (global_cursor < processed.size() && processed[global_cursor] < limit) {
+      batch.documents.push_back(processed[global_cursor]);
+      batch.counts[processed[global_cursor] % world_size] += vocab_size;
+      ++global_cursor;
+    }
+    if (root) {
+      batch.received.resize(batch.documents.size() * vocab_size);
+    }
+    bow::TraceScope scope(trace, "MPI_Igatherv lote de filas");
+    batch.pending = bow::igatherv_large(batch.send.data(), cell_datatype<Cell>(),
+                                        root ? batch.received.data() : nullptr, batch.counts,
+                                        MPI_COMM_WORLD, config.max_message_elements);
+  };
+
+  if (batches > 0) {
+    post_batch(0, slots[0]);
+  }
+  std::vector<std::size_t> next_value(world_size);
+  for (std::size_t k = 0; k < batches; ++k) {
+    if (k + 1 < batches) {
+      post_batch(k + 1, slots[(k + 1) % 2]);
+    }
+    Batch& batch = slots[k % 2];
+    {
+      bow::TraceScope scope(trace, "MPI_Wait lote de filas");
+      batch.pending.wait();
+    }
+    if (!writer) {
+      continue;
+    }
+    next_value[0] = 0;
+    for (int r = 1; r < world_size; ++r) {
+      next_value[r] = next_value[r - 1] + batch.counts[r - 1];
+    }
+    for (int document : batch.documents) {
+      std::size_t& offset = next_value[document % world_size];
+      writer->write_row(std::filesystem::path(config.document_paths[document]).filename().string(),
+                        batch.received.data() + offset, vocab_size);
+      offset += vocab_size;
+    }
+  }
+}
+
+// Arma las filas con la variante de intercambio elegida y rank 0 escribe el CSV. `Cell` es
+// int para conteos y float para pesos TF-IDF.
+template <typename Cell>
+void exchange_and_write(const ExchangeContext& context, int world_size,
+                        const std::vector<bow::WordCounts>& local_counts,
+                        const LocalVocabulary& local_vocab,
+                        const std::vector<int>& local_doc_indices) {
+  const bow::ExperimentConfig& config = context.config;
+  bow::PhaseRecorder& recorder = context.recorder;
+  if (config.gather_batch_documents > 0) {
+    stream_rows_to_root<Cell>(context, world_size, local_counts, local_vocab, local_doc_indices);
+    recorder.end();
+  } else {
+    GatheredRows<Cell> rows =
+        config.nonblocking_collectives && !config.hierarchical_collectives &&
+                !config.shared_vocabulary && !config.sample_sort_vocabulary
+            ? exchange_nonblocking<Cell>(context, local_counts, local_vocab, local_doc_indices)
+            : exchange_blocking<Cell>(context, local_counts, local_vocab, local_doc_indices);
+
+    recorder.end();
+    if (context.world_rank == 0) {
+      recorder.begin("escritura");
+      const int vocab_size = static_cast<int>(rows.vocabulary.size());
+      const int total_rows = static_cast<int>(rows.doc_indices.size());
+      std::vector<std::pair<int, std::vector<Cell>>> ordered_rows;
+      ordered_rows.reserve(total_rows);
+
+      std::size_t offset = 0;
+      for (int i = 0; i < total_rows; ++i) {
+        std::vector<Cell> row(vocab_size, Cell{});
+        if (vocab_size > 0) {
+          std::copy(rows.values.begin() + offset, rows.values.begin() + offset + vocab_size,
+                    row.begin());
+        }
+        ordered_rows.push_back({rows.doc_indices[i], std::move(row)});
+        offset += vocab_size;
+      }
+      std::sort(ordered_rows.begin(), ordered_rows.end(),
+                [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+      std::vector<std::string> doc_names;
+      std::vector<std::vector<Cell>> matrix;
+      doc_names.reserve(ordered_rows.size());
+      matrix.reserve(ordered_rows.size());
+
+      for (const auto& row : ordered_rows) {
+        doc_names.push_back(
+            std::filesystem::path(config.document_paths[row.first]).filename().string());
+        matrix.push_back(row.second);
+      }
+
+      if (!doc_names.empty()) {
+        const std::filesystem::path output_file = std::filesystem::path("results") / "bow_mpi.csv";
+        std::filesystem::create_directories(output_file.parent_path());
+        bow::write_csv(matrix, rows.vocabulary, doc_names, output_file.string());
+      } else {
+        std::cerr << "MPI: No se generaron filas, revisar entradas." << std::endl;
+      }
+      recorder.end();
+    }
+  }
+
+}
+
+}  // namespace
+
+namespace bow {
+
+// Ejecuta la versión MPI distribuyendo documentos y reuniendo resultados en rank 0.
+ExperimentResult run_parallel(const ExperimentConfig& config) {
+  ExperimentResult result;
+  if (config.document_paths.empty()) {
+    return result;
+  }
+
+  int world_rank = 0;
+  int world_size = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+  PhaseRecorder recorder({"lectura", "tokenizacion", "conteo", "flujo_por_bloques",
+                          "conteo_en_hilos", "poda", "vocabulario_local", "intercambio_vocabulario",
+                          "indice_vocabulario", "idf", "filas", "recoleccion", "filas_por_lotes",
+                          "escritura"},
+                         config.collect_perf_counters);
+  TraceRecorder trace(!config.trace_path.empty());
+  reset_peak_rss();
+  recorder.attach_trace(&trace);
+  const auto start_time = std::chrono::steady_clock::now();
+
+  // Documentos asignados a este rank en round-robin, en el orden en que se procesarán.
+  std::vector<std::size_t> assigned_indices;
+  std::vector<std::string> assigned_paths;
+  for (std::size_t idx = world_rank; idx < config.document_paths.size(); idx += world_size) {
+    assigned_indices.push_back(idx);
+    assigned_paths.push_back(config.document_paths[idx]);
+  }
+
+  // Con --hierarchical cada nodo reúne y une primero sus datos en su líder (los mensajes
+  // dentro del nodo van por memoria compartida) y solo los líderes hablan por la red.
+  std::unique_ptr<NodeTopology> topology;
+  if (config.hierarchical_collectives || config.shared_vocabulary) {
+    topology = std::make_unique<NodeTopology>();
+  }
+
+  DocumentCounts documents = count_documents(assigned_paths, config, recorder);
+  std::vector<WordCounts> local_counts = std::move(documents.counts);
+  std::vector<int> local_doc_indices;
+  local_doc_indices.reserve(documents.positions.size());
+  for (std::size_t position : documents.positions) {
+    local_doc_indices.push_back(static_cast<int>(assigned_indices[position]));
+  }
+
+  const SymbolTable& symbols = *documents.symbols;
+  if (config.pruning.enabled()) {
+    // Todos los ranks entran a la colectiva, aunque no tengan documentos.
+    recorder.begin("poda");
+    drop_pruned(local_counts,
+                prune_symbols_distributed(symbols, local_counts, config.pruning, MPI_COMM_WORLD,
+                                          trace, config.max_message_elements));
+  }
+
+  recorder.begin("vocabulario_local");
+  // Símbolos que aparecen en algún conteo (cada palabra distinta una vez por rank).
+  std::vector<char> used(symbols.size(), 0);
+  for (const auto& doc_map : local_counts) {
+    for (const auto& entry : doc_map) {
+      used[entry.first] = 1;
+    }
+  }
+  LocalVocabulary local_vocab{symbols, {}, {}};
+  for (SymbolId id = 0; id < used.size(); ++id) {
+    if (used[id] != 0) {
+      local_vocab.sorted.push_back(id);
+    }
+  }
+  symbols.sort_by_word(local_vocab.sorted);
+  for (SymbolId id : local_vocab.sorted) {
+    local_vocab.serialized += symbols.word(id);
+    local_vocab.serialized.push_back('\n');
+  }
+
+  const ExchangeContext context{config, recorder, trace, topology.get(), world_rank};
+  if (config.tfidf.enabled) {
+    exchange_and_write<float>(context, world_size, local_counts, local_vocab, local_doc_indices);
+  } else {
+    exchange_and_write<int>(context, world_size, local_counts, local_vocab, local_doc_indices);
+  }
+
   // Aseguramos que todos escribieron/envíaron antes de tomar el tiempo final.
-  MPI_Barrier(MPI_COMM_WORLD);
+  {
+    TraceScope scope(trace, "MPI_Barrier final");
+    MPI_Barrier(MPI_COMM_WORLD);
+  }
   const auto end_time = std::chrono::steady_clock::now();
   const double local_elapsed =
       std::chrono::duration<double, std::milli>(end_time - start_time).count();
@@ -336,6 +911,26 @@ ExperimentResult run_parallel(const ExperimentConfig& config) {
     result.total_time_ms = max_elapsed;
     result.average_time_ms = max_elapsed;
   }
+  // Fuera de la ventana medida para no sumar el costo de la propia instrumentación.
+  result.phases = reduce_phase_metrics(recorder.phases(), world_rank);
+  result.peak_rss_bytes = gather_peak_rss(world_rank, world_size);
+  const double local_sums[3] = {documents.io_read_ms, documents.io_wait_ms,
+                              documents.scheduler.idle_ms};
+  double total_sums[3] = {0.0, 0.0, 0.0};
+  MPI_Reduce(local_sums, total_sums, 3, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  result.io_read_ms = total_sums[0];
+  result.io_wait_ms = total_sums[1];
+  result.scheduler.idle_ms = total_sums[2];
+  const std::uint64_t local_tasks[3] = {documents.scheduler.tasks, documents.scheduler.steals,
+                                        documents.scheduler.failed_steals};
+  std::uint64_t total_tasks[3] = {0, 0, 0};
+  MPI_Reduce(local_tasks, total_tasks, 3, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  result.scheduler.tasks = total_tasks[0];
+  result.scheduler.steals = total_tasks[1];
+  result.scheduler.failed_steals = total_tasks[2];
+  if (trace.enabled()) {
+    write_merged_trace_mpi(trace, config.trace_path);
+  }
 
   return result;
 }
@@ -0,0 +1,127 @@
+// perf_counters.cpp: Lectura de contadores de hardware con la llamada perf_event_open de Linux.
+#include "bow/perf_counters.hpp"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+namespace bow {
+
+HardwareCounters& HardwareCounters::operator+=(const HardwareCounters& other) {
+  cycles += other.cycles;
+  instructions += other.instructions;
+  cache_misses += other.cache_misses;
+  branch_misses += other.branch_misses;
+  dtlb_misses += other.dtlb_misses;
+  available = available || other.available;
+  return *this;
+}
+
+HardwareCounters operator-(const HardwareCounters& end, const HardwareCounters& begin) {
+  // Con multiplexación la escala puede hacer que una lectura posterior sea menor; saturamos en 0.
+  const auto delta = [](std::uint64_t lhs, std::uint64_t rhs) { return lhs > rhs ? lhs - rhs : 0; };
+  HardwareCounters diff;
+  diff.cycles = delta(end.cycles, begin.cycles);
+  diff.instructions = delta(end.instructions, begin.instructions);
+  diff.cache_misses = delta(end.cache_misses, begin.cache_misses);
+  diff.branch_misses = delta(end.branch_misses, begin.branch_misses);
+  diff.dtlb_misses = delta(end.dtlb_misses, begin.dtlb_misses);
+  diff.available = end.available && begin.available;
+  return diff;
+}
+
+double instructions_per_cycle(const HardwareCounters& counters) {
+  return counters.cycles > 0
+             ? static_cast<double>(counters.instructions) / static_cast<double>(counters.cycles)
+             : 0.0;
+}
+
+#if defined(__linux__)
+
+namespace {
+
+// Abre un evento para el hilo actual en cualquier CPU, solo en modo usuario. Con `inherit` el
+// contador también cubre los hilos que se creen después (los trabajadores de TaskScheduler,
+// el hilo de --prefetch), y leerlo suma los de todos ellos.
+int open_event(std::uint32_t type, std::uint64_t config) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.exclude_kernel = 1;  // Permite usarlo con perf_event_paranoid = 2.
+  attr.exclude_hv = 1;
+  attr.inherit = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+// Lee un contador y lo escala si el kernel lo multiplexó con otros eventos.
+std::uint64_t read_scaled(int fd) {
+  if (fd < 0) {
+    return 0;
+  }
+  std::uint64_t values[3] = {0, 0, 0};  // valor, tiempo habilitado, tiempo corriendo.
+  if (::read(fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) ||
+      values[2] == 0) {
+    return 0;
+  }
+  if (values[2] == values[1]) {
+    return values[0];
+  }
+  return static_cast<std::uint64_t>(static_cast<double>(values[0]) *
+                                    (static_cast<double>(values[1]) / values[2]));
+}
+
+}  // namespace
+
+PerfCounterSet::PerfCounterSet() {
+  const std::uint64_t dtlb_read_miss = PERF_COUNT_HW_CACHE_DTLB |
+                                       (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  fds_[0] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  fds_[1] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  fds_[2] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  fds_[3] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+  fds_[4] = open_event(PERF_TYPE_HW_CACHE, dtlb_read_miss);
+}
+
+PerfCounterSet::~PerfCounterSet() {
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+bool PerfCounterSet::available() const { return fds_[0] >= 0; }
+
+HardwareCounters PerfCounterSet::read() const {
+  HardwareCounters counters;
+  if (!available()) {
+    return counters;
+  }
+  counters.cycles = read_scaled(fds_[0]);
+  counters.instructions = read_scaled(fds_[1]);
+  counters.cache_misses = read_scaled(fds_[2]);
+  counters.branch_misses = read_scaled(fds_[3]);
+  counters.dtlb_misses = read_scaled(fds_[4]);
+  counters.available = true;
+  return counters;
+}
+
+#else
+
+// Fuera de Linux no hay perf_event_open: el conjunto queda siempre inactivo.
+PerfCounterSet::PerfCounterSet() { fds_.fill(-1); }
+PerfCounterSet::~PerfCounterSet() = default;
+bool PerfCounterSet::available() const { return false; }
+HardwareCounters PerfCounterSet::read() const { return {}; }
+
+#endif
+
+}  // namespace bow
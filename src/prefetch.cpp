@@ -0,0 +1,94 @@
+// prefetch.cpp: Doble buffer de documentos con un hilo lector auxiliar.
+#include "bow/prefetch.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace {
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+namespace bow {
+
+DocumentPrefetcher::DocumentPrefetcher(std::vector<std::string> paths, DocumentReader reader,
+                                       bool enabled)
+    : DocumentPrefetcher(std::move(paths), make_batch_reader(ReaderBackend::kIfstream, reader), 1,
+                         enabled) {}
+
+DocumentPrefetcher::DocumentPrefetcher(std::vector<std::string> paths, BatchReader reader,
+                                       std::size_t batch_size, bool enabled)
+    : paths_(std::move(paths)),
+      reader_(std::move(reader)),
+      batch_size_(batch_size > 0 ? batch_size : 1),
+      enabled_(enabled) {
+  if (enabled_) {
+    launch(0);
+  }
+}
+
+DocumentPrefetcher::~DocumentPrefetcher() {
+  if (pending_.valid()) {
+    pending_.wait();  // No dejamos al hilo lector apuntando a un objeto destruido.
+  }
+}
+
+std::vector<std::string> DocumentPrefetcher::read_batch(std::size_t first) {
+  const std::size_t last = std::min(first + batch_size_, paths_.size());
+  const std::vector<std::string> batch(paths_.begin() + first, paths_.begin() + last);
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::string> contents = reader_(batch);
+  read_ms_ += elapsed_ms(start);
+  return contents;
+}
+
+void DocumentPrefetcher::launch(std::size_t first) {
+  if (first >= paths_.size()) {
+    return;
+  }
+  pending_ = std::async(std::launch::async, [this, first]() { return read_batch(first); });
+}
+
+std::string DocumentPrefetcher::next() {
+  if (current_pos_ == current_.size()) {
+    if (next_batch_ >= paths_.size()) {
+      return {};
+    }
+    const auto start = std::chrono::steady_clock::now();
+    if (enabled_) {
+      current_ = pending_.get();
+      wait_ms_ += elapsed_ms(start);
+      next_batch_ += batch_size_;
+      launch(next_batch_);  // El siguiente lote se lee mientras el llamador tokeniza este.
+    } else {
+      current_ = read_batch(next_batch_);
+      wait_ms_ += elapsed_ms(start);
+      next_batch_ += batch_size_;
+    }
+    current_pos_ = 0;
+  }
+  return std::move(current_[current_pos_++]);
+}
+
+void advise_will_need(const std::string& path) {
+#if defined(POSIX_FADV_WILLNEED)
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+  close(fd);
+#else
+  (void)path;
+#endif
+}
+
+}  // namespace bow
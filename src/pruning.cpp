@@ -0,0 +1,84 @@
+// pruning.cpp: Estadísticas por término y poda del vocabulario en un solo proceso.
+#include "bow/pruning.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+
+namespace bow {
+
+bool parse_document_frequency(const std::string& text, DocumentFrequencyBound& bound) {
+  if (text.empty() || text.find_first_not_of("0123456789.") != std::string::npos) {
+    return false;
+  }
+  char* end = nullptr;
+  const double value = std::strtod(text.c_str(), &end);
+  const bool proportion = text.find('.') != std::string::npos;
+  if (end != text.c_str() + text.size() || (proportion && value > 1.0)) {
+    return false;
+  }
+  bound = {value, proportion};
+  return true;
+}
+
+bool parse_max_features(const std::string& text, std::size_t& max_features) {
+  if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  errno = 0;
+  const unsigned long long value = std::strtoull(text.c_str(), nullptr, 10);
+  if (errno == ERANGE || value > std::numeric_limits<std::size_t>::max()) {
+    return false;
+  }
+  max_features = static_cast<std::size_t>(value);
+  return true;
+}
+
+TermStatistics term_statistics(const std::vector<WordCounts>& counts, std::size_t symbols) {
+  TermStatistics stats;
+  stats.document_frequency.assign(symbols, 0);
+  stats.total.assign(symbols, 0);
+  for (const auto& document_map : counts) {
+    for (const auto& entry : document_map) {
+      ++stats.document_frequency[entry.first];
+      stats.total[entry.first] += static_cast<std::uint64_t>(entry.second);
+    }
+  }
+  return stats;
+}
+
+std::vector<char> prune_symbols(const SymbolTable& symbols, const std::vector<WordCounts>& counts,
+                                const VocabularyPruning& pruning) {
+  const TermStatistics stats = term_statistics(counts, symbols.size());
+  std::vector<SymbolId> kept;
+  for (SymbolId id = 0; id < symbols.size(); ++id) {
+    if (stats.document_frequency[id] > 0 &&
+        pruning.keeps_frequency(stats.document_frequency[id], counts.size())) {
+      kept.push_back(id);
+    }
+  }
+  if (pruning.max_features > 0 && kept.size() > pruning.max_features) {
+    const auto first = kept.begin() + static_cast<std::ptrdiff_t>(pruning.max_features);
+    std::nth_element(kept.begin(), first - 1, kept.end(), [&](SymbolId lhs, SymbolId rhs) {
+      return ranks_before(stats.total[lhs], symbols.word(lhs), stats.total[rhs],
+                          symbols.word(rhs));
+    });
+    kept.erase(first, kept.end());
+  }
+  std::vector<char> keep(symbols.size(), 0);
+  for (const SymbolId id : kept) {
+    keep[id] = 1;
+  }
+  return keep;
+}
+
+void drop_pruned(std::vector<WordCounts>& counts, const std::vector<char>& keep) {
+  for (auto& document_map : counts) {
+    document_map.erase(std::remove_if(document_map.begin(), document_map.end(),
+                                      [&](const auto& entry) { return keep[entry.first] == 0; }),
+                       document_map.end());
+  }
+}
+
+}  // namespace bow
@@ -0,0 +1,125 @@
+// sample_sort_mpi.cpp: Sample sort distribuido del vocabulario (separadores, MPI_Alltoallv).
+#include "bow/sample_sort.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <string_view>
+
+#include "bow/serialized_words.hpp"
+
+namespace {
+
+// Muestras por rank y por destino: más muestras dan rangos más parejos entre ranks.
+constexpr std::size_t kOversampling = 16;
+
+}  // namespace
+
+namespace bow {
+
+SortedVocabularyRange sample_sort_vocabulary(const std::string& local_serialized, MPI_Comm comm,
+                                             TraceRecorder& trace, std::uint64_t max_message) {
+  int rank = 0;
+  int size = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  const std::vector<std::string_view> local_words = split_words(local_serialized);
+
+  // 1. Muestras regulares y separadores.
+  const std::size_t sample_count =
+      std::min(local_words.size(), kOversampling * static_cast<std::size_t>(size));
+  std::string samples;
+  for (std::size_t i = 0; i < sample_count; ++i) {
+    samples += local_words[i * local_words.size() / sample_count];
+    samples.push_back('\n');
+  }
+  const std::uint64_t sample_bytes = samples.size();
+  std::vector<std::uint64_t> sample_counts(size, 0);
+  {
+    TraceScope scope(trace, "MPI_Allgather tamaños muestras");
+    MPI_Allgather(&sample_bytes, 1, MPI_UINT64_T, sample_counts.data(), 1, MPI_UINT64_T, comm);
+  }
+  std::string all_samples(total_of(sample_counts), '\0');
+  {
+    TraceScope scope(trace, "MPI_Allgatherv muestras");
+    allgatherv_large(samples.data(), MPI_CHAR, all_samples.data(), sample_counts, comm,
+                     max_message);
+  }
+  std::vector<std::string_view> sorted_samples = split_words(all_samples);
+  std::sort(sorted_samples.begin(), sorted_samples.end());
+  std::vector<std::string_view> splitters;
+  if (!sorted_samples.empty()) {
+    for (int b = 1; b < size; ++b) {
+      splitters.push_back(sorted_samples[b * sorted_samples.size() / size]);
+    }
+  }
+
+  // 2. Partición: el destino b recibe las palabras en (separador b - 1, separador b]. Como el
+  // vocabulario local está ordenado, cada destino es un tramo contiguo del texto.
+  std::vector<std::uint64_t> send_bytes(size, 0);
+  std::vector<std::uint64_t> send_words(size, 0);
+  std::size_t word = 0;
+  for (int b = 0; b < size; ++b) {
+    const std::size_t first = word;
+    if (b + 1 < size && !splitters.empty()) {
+      word = std::upper_bound(local_words.begin() + first, local_words.end(), splitters[b]) -
+             local_words.begin();
+    } else if (b + 1 == size) {
+      word = local_words.size();
+    }
+    send_words[b] = word - first;
+    for (std::size_t w = first; w < word; ++w) {
+      send_bytes[b] += local_words[w].size() + 1;
+    }
+  }
+
+  std::vector<std::uint64_t> recv_bytes(size, 0);
+  std::vector<std::uint64_t> recv_words(size, 0);
+  {
+    TraceScope scope(trace, "MPI_Alltoall tamaños vocabulario");
+    MPI_Alltoall(send_bytes.data(), 1, MPI_UINT64_T, recv_bytes.data(), 1, MPI_UINT64_T, comm);
+    MPI_Alltoall(send_words.data(), 1, MPI_UINT64_T, recv_words.data(), 1, MPI_UINT64_T, comm);
+  }
+  std::string received(total_of(recv_bytes), '\0');
+  {
+    TraceScope scope(trace, "MPI_Alltoallv vocabulario");
+    alltoallv_large(local_serialized.data(), send_bytes, received.data(), recv_bytes, MPI_CHAR,
+                    comm, max_message);
+  }
+
+  // 3. Orden local del rango recibido y columna inicial de este rank.
+  const std::vector<std::string_view> received_words = split_words(received);
+  std::vector<std::string_view> owned = received_words;
+  std::sort(owned.begin(), owned.end());
+  owned.erase(std::unique(owned.begin(), owned.end()), owned.end());
+
+  SortedVocabularyRange range;
+  range.owned_words = owned.size();
+  for (std::string_view owned_word : owned) {
+    range.owned += owned_word;
+    range.owned.push_back('\n');
+  }
+  {
+    TraceScope scope(trace, "MPI_Exscan columnas");
+    MPI_Exscan(&range.owned_words, &range.first_column, 1, MPI_UINT64_T, MPI_SUM, comm);
+    MPI_Allreduce(&range.owned_words, &range.total_words, 1, MPI_UINT64_T, MPI_SUM, comm);
+  }
+  if (rank == 0) {
+    range.first_column = 0;  // MPI_Exscan deja indefinido el resultado de rank 0.
+  }
+
+  // 4. Columnas de regreso, en el mismo orden en que llegaron las palabras.
+  std::vector<std::uint64_t> reply(received_words.size());
+  for (std::size_t i = 0; i < received_words.size(); ++i) {
+    reply[i] = range.first_column +
+               (std::lower_bound(owned.begin(), owned.end(), received_words[i]) - owned.begin());
+  }
+  range.local_columns.resize(local_words.size());
+  {
+    TraceScope scope(trace, "MPI_Alltoallv columnas");
+    alltoallv_large(reply.data(), recv_words, range.local_columns.data(), send_words,
+                    MPI_UINT64_T, comm, max_message);
+  }
+  return range;
+}
+
+}  // namespace bow
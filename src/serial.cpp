@@ -1,125 +1,80 @@
 // serial.cpp: La versión secuencial del algoritmo.
 #include "bow/serial.hpp"
 
-#include <algorithm>
 #include <chrono>
-#include <cctype>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
-#include <map>
-#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
-namespace {
-
-// Lee un archivo completo y regresa su contenido como string.
-std::string read_file(const std::string& path) {
-  std::ifstream input(path);
-  if (!input.is_open()) {
-    std::cerr << "No se pudo abrir el archivo: " << path << std::endl;
-    return {};
-  }
-
-  std::ostringstream buffer;
-  buffer << input.rdbuf();
-  return buffer.str();
-}
-
-// Normaliza y tokeniza el contenido manejando separadores como comas o espacios.
-std::vector<std::string> tokenize_document(const std::string& content) {
-  std::vector<std::string> tokens;
-  std::string current_token;
-
-  for (unsigned char raw : content) {
-    const char lower = static_cast<char>(std::tolower(raw));
-    if (std::isalnum(lower) || lower == '_') {
-      current_token.push_back(lower);
-    } else {
-      if (!current_token.empty()) {
-        tokens.push_back(current_token);
-        current_token.clear();
-      }
-    }
-  }
+#include "bow/core.hpp"
+#include "bow/memory_stats.hpp"
+#include "bow/metrics.hpp"
+#include "bow/pruning.hpp"
 
-  if (!current_token.empty()) {
-    tokens.push_back(current_token);
-  }
-  return tokens;
-}
-
-// Cuenta la frecuencia de cada token dentro de un documento.
-std::map<std::string, int> count_tokens(const std::vector<std::string>& tokens) {
-  std::map<std::string, int> word_counts;
-  for (const auto& token : tokens) {
-    ++word_counts[token];
-  }
-  return word_counts;
-}
+namespace {
 
-// Construye el vocabulario global ordenado (columnas del CSV) usando todos los documentos.
-std::vector<std::string> build_vocabulary(
-    const std::vector<std::map<std::string, int>>& document_counts) {
-  std::map<std::string, int> ordered_unique_tokens;
+// Construye el vocabulario global ordenado (columnas del CSV) usando todos los documentos:
+// los símbolos que aparecen en algún conteo, ordenados por su palabra. Regresa además la
+// columna de cada símbolo.
+std::vector<std::string> build_vocabulary(const bow::SymbolTable& symbols,
+                                          const std::vector<bow::WordCounts>& document_counts,
+                                          std::vector<int>& column_of_symbol) {
+  std::vector<char> used(symbols.size(), 0);
   for (const auto& document_map : document_counts) {
     for (const auto& entry : document_map) {
-      ordered_unique_tokens.emplace(entry.first, 0);  // map mantiene orden y evita duplicados.
+      used[entry.first] = 1;
+    }
+  }
+  std::vector<bow::SymbolId> ids;
+  for (bow::SymbolId id = 0; id < used.size(); ++id) {
+    if (used[id] != 0) {
+      ids.push_back(id);
     }
   }
+  symbols.sort_by_word(ids);  // Cada palabra se compara una vez por símbolo, no por documento.
 
   std::vector<std::string> vocabulary;
-  vocabulary.reserve(ordered_unique_tokens.size());
-  for (const auto& entry : ordered_unique_tokens) {
-    vocabulary.push_back(entry.first);
+  vocabulary.reserve(ids.size());
+  column_of_symbol.assign(symbols.size(), -1);
+  for (std::size_t column = 0; column < ids.size(); ++column) {
+    vocabulary.emplace_back(symbols.word(ids[column]));
+    column_of_symbol[ids[column]] = static_cast<int>(column);
   }
   return vocabulary;
 }
 
-// Genera la matriz bolsa de palabras recorriendo documentos y vocabulario.
-std::vector<std::vector<int>> build_matrix(
-    const std::vector<std::map<std::string, int>>& document_counts,
-    const std::vector<std::string>& vocabulary) {
+// Genera la matriz bolsa de palabras: cada conteo cae directo en la columna de su símbolo.
+std::vector<std::vector<int>> build_matrix(const std::vector<bow::WordCounts>& document_counts,
+                                           const std::vector<int>& column_of_symbol,
+                                           std::size_t vocabulary_size) {
   std::vector<std::vector<int>> matrix;
   matrix.reserve(document_counts.size());
 
   for (const auto& document_map : document_counts) {
-    std::vector<int> row;
-    row.reserve(vocabulary.size());
-    for (const auto& word : vocabulary) {
-      const auto it = document_map.find(word);
-      row.push_back(it != document_map.end() ? it->second : 0);  // 0 si la palabra no aparece.
+    std::vector<int> row(vocabulary_size, 0);  // 0 si la palabra no aparece.
+    for (const auto& entry : document_map) {
+      row[column_of_symbol[entry.first]] = entry.second;
     }
     matrix.push_back(std::move(row));
   }
   return matrix;
 }
 
-// Escribe la matriz resultante en un archivo CSV.
-void write_csv(const std::vector<std::vector<int>>& matrix,
-               const std::vector<std::string>& vocabulary,
-               const std::vector<std::string>& doc_names,
-               const std::string& output_path) {
-  std::ofstream output(output_path);
-  if (!output.is_open()) {
-    std::cerr << "No se pudo abrir el CSV de salida: " << output_path << std::endl;
-    return;
-  }
-
-  output << "document";
-  for (const auto& word : vocabulary) {
-    output << ',' << word;
-  }
-  output << '\n';
-
-  for (std::size_t i = 0; i < matrix.size(); ++i) {
-    output << doc_names[i];
-    for (int value : matrix[i]) {
-      output << ',' << value;
-    }
-    output << '\n';
+// Igual que build_matrix, con los pesos TF-IDF de cada documento (--tfidf).
+std::vector<std::vector<float>> build_tfidf_matrix(
+    const std::vector<bow::WordCounts>& document_counts, const std::vector<int>& column_of_symbol,
+    std::size_t vocabulary_size, const std::vector<double>& idf, bool sublinear_tf) {
+  std::vector<std::vector<float>> matrix;
+  matrix.reserve(document_counts.size());
+  std::vector<std::pair<int, double>> scratch;
+  for (const auto& document_map : document_counts) {
+    std::vector<float> row(vocabulary_size, 0.0f);
+    bow::weight_row(document_map, column_of_symbol, idf, sublinear_tf, row.data(), scratch);
+    matrix.push_back(std::move(row));
   }
+  return matrix;
 }
 
 }  // namespace
@@ -134,20 +89,19 @@ ExperimentResult run_serial(const ExperimentConfig& config) {
     return result;
   }
 
+  PhaseRecorder recorder({"lectura", "tokenizacion", "conteo", "flujo_por_bloques",
+                          "conteo_en_hilos", "poda", "vocabulario", "idf", "matriz", "escritura"},
+                         config.collect_perf_counters);
+  reset_peak_rss();
   const auto start_time = std::chrono::steady_clock::now();
 
-  std::vector<std::map<std::string, int>> document_counts;
+  DocumentCounts documents = count_documents(config.document_paths, config, recorder);
+  std::vector<bow::WordCounts>& document_counts = documents.counts;
   std::vector<std::string> processed_names;
-
-  for (const auto& document_path : config.document_paths) {
-    const std::string content = read_file(document_path);
-    if (content.empty()) {
-      continue;
-    }
-
-    const std::vector<std::string> tokens = tokenize_document(content);
-    document_counts.push_back(count_tokens(tokens));
-    processed_names.push_back(std::filesystem::path(document_path).filename().string());
+  processed_names.reserve(documents.positions.size());
+  for (std::size_t position : documents.positions) {
+    processed_names.push_back(
+        std::filesystem::path(config.document_paths[position]).filename().string());
   }
 
   if (document_counts.empty()) {
@@ -155,18 +109,46 @@ ExperimentResult run_serial(const ExperimentConfig& config) {
     return result;
   }
 
-  const std::vector<std::string> vocabulary = build_vocabulary(document_counts);
-  const std::vector<std::vector<int>> matrix = build_matrix(document_counts, vocabulary);
+  if (config.pruning.enabled()) {
+    recorder.begin("poda");
+    drop_pruned(document_counts, prune_symbols(*documents.symbols, document_counts, config.pruning));
+  }
 
+  recorder.begin("vocabulario");
+  std::vector<int> column_of_symbol;
+  const std::vector<std::string> vocabulary =
+      build_vocabulary(*documents.symbols, document_counts, column_of_symbol);
   const std::filesystem::path output_file = std::filesystem::path("results") / "bow_serial.csv";
   std::filesystem::create_directories(output_file.parent_path());
-  write_csv(matrix, vocabulary, processed_names, output_file.string());
+  if (config.tfidf.enabled) {
+    recorder.begin("idf");
+    const std::vector<double> idf = inverse_document_frequency(
+        column_document_frequency(document_counts, column_of_symbol, vocabulary.size()),
+        document_counts.size(), config.tfidf.smooth_idf);
+    recorder.begin("matriz");
+    const std::vector<std::vector<float>> matrix = build_tfidf_matrix(
+        document_counts, column_of_symbol, vocabulary.size(), idf, config.tfidf.sublinear_tf);
+    recorder.begin("escritura");
+    write_csv(matrix, vocabulary, processed_names, output_file.string());
+  } else {
+    recorder.begin("matriz");
+    const std::vector<std::vector<int>> matrix =
+        build_matrix(document_counts, column_of_symbol, vocabulary.size());
+    recorder.begin("escritura");
+    write_csv(matrix, vocabulary, processed_names, output_file.string());
+  }
+  recorder.end();
 
   const auto end_time = std::chrono::steady_clock::now();
   const double elapsed_ms =
       std::chrono::duration<double, std::milli>(end_time - start_time).count();
   result.total_time_ms = elapsed_ms;
   result.average_time_ms = elapsed_ms;
+  result.phases = recorder.phases();
+  result.peak_rss_bytes = {peak_rss_bytes()};
+  result.io_read_ms = documents.io_read_ms;
+  result.io_wait_ms = documents.io_wait_ms;
+  result.scheduler = documents.scheduler;
   return result;
 }
 
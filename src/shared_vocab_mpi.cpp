@@ -0,0 +1,148 @@
+// shared_vocab_mpi.cpp: Difusión del vocabulario a líderes de nodo y ventana compartida por nodo.
+#include "bow/shared_vocab.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include "bow/large_count.hpp"
+#include "bow/symbol_table.hpp"
+
+namespace {
+
+std::uint64_t table_capacity_for(std::uint64_t words) {
+  std::uint64_t capacity = 16;
+  while (capacity < words * 2) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+// Redondea al múltiplo de 8 para que cada sección quede alineada.
+std::uint64_t align8(std::uint64_t bytes) { return (bytes + 7) & ~std::uint64_t{7}; }
+
+}  // namespace
+
+namespace bow {
+
+SharedVocabulary::SharedVocabulary(const std::string& serialized, const NodeTopology& topology,
+                                   TraceRecorder& trace, std::uint64_t max_message) {
+  int world_rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  const int node_rank = topology.node_rank();
+  const MPI_Comm node_comm = topology.node_comm();
+  const MPI_Comm leader_comm = topology.leader_comm();
+
+  // Solo los líderes reciben el vocabulario serializado.
+  std::string text;
+  if (leader_comm != MPI_COMM_NULL) {
+    std::uint64_t text_bytes = serialized.size();
+    {
+      TraceScope scope(trace, "MPI_Bcast tamaño vocabulario (líderes)");
+      MPI_Bcast(&text_bytes, 1, MPI_UINT64_T, 0, leader_comm);
+    }
+    text = world_rank == 0 ? serialized : std::string(text_bytes, '\0');
+    {
+      TraceScope scope(trace, "MPI_Bcast vocabulario (líderes)");
+      bcast_large(text.data(), text_bytes, MPI_CHAR, leader_comm, max_message);
+    }
+  }
+
+  // El líder calcula el tamaño de la ventana; el resto aporta 0 bytes y la consulta después.
+  std::vector<std::uint64_t> offsets;
+  std::uint64_t capacity = 0;
+  MPI_Aint window_bytes = 0;
+  if (node_rank == 0) {
+    offsets.push_back(0);
+    for (std::size_t i = 0; i < text.size(); ++i) {
+      if (text[i] == '\n') {
+        offsets.push_back(i + 1);
+      }
+    }
+    capacity = table_capacity_for(offsets.size() - 1);
+    window_bytes = static_cast<MPI_Aint>(
+        sizeof(Header) + align8(offsets.size() * sizeof(std::uint64_t)) +
+        align8(capacity * sizeof(std::int32_t)) + align8(text.size()));
+  }
+
+  char* base = nullptr;
+  {
+    TraceScope scope(trace, "MPI_Win_allocate_shared vocabulario");
+    MPI_Win_allocate_shared(window_bytes, 1, MPI_INFO_NULL, node_comm, &base, &window_);
+  }
+  if (node_rank != 0) {
+    MPI_Aint size = 0;
+    int displacement_unit = 0;
+    MPI_Win_shared_query(window_, 0, &size, &displacement_unit, &base);
+  }
+
+  // Época pasiva: el líder escribe, MPI_Win_sync + barrera publican la memoria al resto.
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, window_);
+  if (node_rank == 0) {
+    const std::uint64_t word_count = offsets.size() - 1;
+    auto* header = reinterpret_cast<Header*>(base);
+    auto* shared_offsets = reinterpret_cast<std::uint64_t*>(base + sizeof(Header));
+    auto* table = reinterpret_cast<std::int32_t*>(
+        reinterpret_cast<char*>(shared_offsets) + align8(offsets.size() * sizeof(std::uint64_t)));
+    char* shared_text = reinterpret_cast<char*>(table) + align8(capacity * sizeof(std::int32_t));
+
+    header->word_count = word_count;
+    header->table_capacity = capacity;
+    header->text_bytes = text.size();
+    header->total_bytes = static_cast<std::uint64_t>(window_bytes);
+    std::memcpy(shared_offsets, offsets.data(), offsets.size() * sizeof(std::uint64_t));
+    if (!text.empty()) {
+      std::memcpy(shared_text, text.data(), text.size());
+    }
+    for (std::uint64_t slot = 0; slot < capacity; ++slot) {
+      table[slot] = -1;
+    }
+    const std::uint64_t mask = capacity - 1;
+    for (std::uint64_t column = 0; column < word_count; ++column) {
+      const std::string_view word(shared_text + offsets[column],
+                                  offsets[column + 1] - offsets[column] - 1);
+      std::uint64_t slot = hash_word(word) & mask;
+      while (table[slot] != -1) {
+        slot = (slot + 1) & mask;
+      }
+      table[slot] = static_cast<std::int32_t>(column);
+    }
+  }
+  MPI_Win_sync(window_);
+  {
+    TraceScope scope(trace, "MPI_Barrier vocabulario compartido");
+    MPI_Barrier(node_comm);
+  }
+  MPI_Win_sync(window_);
+
+  header_ = reinterpret_cast<const Header*>(base);
+  offsets_ = reinterpret_cast<const std::uint64_t*>(base + sizeof(Header));
+  table_ = reinterpret_cast<const std::int32_t*>(
+      reinterpret_cast<const char*>(offsets_) +
+      align8((header_->word_count + 1) * sizeof(std::uint64_t)));
+  text_ = reinterpret_cast<const char*>(table_) +
+          align8(header_->table_capacity * sizeof(std::int32_t));
+}
+
+SharedVocabulary::~SharedVocabulary() {
+  MPI_Win_unlock_all(window_);
+  MPI_Win_free(&window_);
+}
+
+int SharedVocabulary::find(std::string_view word) const {
+  const std::uint64_t mask = header_->table_capacity - 1;
+  for (std::uint64_t slot = hash_word(word) & mask;; slot = (slot + 1) & mask) {
+    const std::int32_t column = table_[slot];
+    if (column < 0) {
+      return -1;
+    }
+    if (this->word(column) == word) {
+      return column;
+    }
+  }
+}
+
+std::string_view SharedVocabulary::word(int column) const {
+  return std::string_view(text_ + offsets_[column], offsets_[column + 1] - offsets_[column] - 1);
+}
+
+}  // namespace bow
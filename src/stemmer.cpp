@@ -0,0 +1,725 @@
+// stemmer.cpp: Stemmer de Porter (inglés) y de Snowball (español).
+#include "bow/stemmer.hpp"
+
+#include <initializer_list>
+
+namespace {
+
+// ---- Porter -------------------------------------------------------------------------------
+// Traducción directa de la implementación de referencia en C de Martin Porter: b_[0..k_] es la
+// palabra en curso y j_ marca el final de la raíz al probar un sufijo.
+class PorterStemmer {
+ public:
+  explicit PorterStemmer(std::string_view word)
+      : b_(word), k_(static_cast<int>(word.size()) - 1) {}
+
+  std::string run() {
+    if (k_ > 1) {  // Las palabras de una o dos letras no se tocan.
+      step1ab();
+      if (k_ > 0) {
+        step1c();
+        step2();
+        step3();
+        step4();
+        step5();
+      }
+    }
+    b_.resize(static_cast<std::size_t>(k_ + 1));
+    return b_;
+  }
+
+ private:
+  bool consonant(int i) const {
+    switch (b_[i]) {
+      case 'a':
+      case 'e':
+      case 'i':
+      case 'o':
+      case 'u':
+        return false;
+      case 'y':
+        return i == 0 || !consonant(i - 1);
+      default:
+        return true;
+    }
+  }
+
+  // Número de secuencias vocal-consonante en b_[0..j_] (la m de Porter).
+  int measure() const {
+    int n = 0;
+    int i = 0;
+    for (;; ++i) {
+      if (i > j_) {
+        return n;
+      }
+      if (!consonant(i)) {
+        break;
+      }
+    }
+    ++i;
+    for (;;) {
+      for (;; ++i) {
+        if (i > j_) {
+          return n;
+        }
+        if (consonant(i)) {
+          break;
+        }
+      }
+      ++i;
+      ++n;
+      for (;; ++i) {
+        if (i > j_) {
+          return n;
+        }
+        if (!consonant(i)) {
+          break;
+        }
+      }
+      ++i;
+    }
+  }
+
+  bool vowel_in_stem() const {
+    for (int i = 0; i <= j_; ++i) {
+      if (!consonant(i)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool double_consonant(int i) const { return i >= 1 && b_[i] == b_[i - 1] && consonant(i); }
+
+  // Consonante-vocal-consonante terminando en i, con la última distinta de w, x, y.
+  bool cvc(int i) const {
+    if (i < 2 || !consonant(i) || consonant(i - 1) || !consonant(i - 2)) {
+      return false;
+    }
+    return b_[i] != 'w' && b_[i] != 'x' && b_[i] != 'y';
+  }
+
+  bool ends(std::string_view suffix) {
+    const int length = static_cast<int>(suffix.size());
+    if (length > k_ + 1 || b_.compare(k_ - length + 1, length, suffix) != 0) {
+      return false;
+    }
+    j_ = k_ - length;
+    return true;
+  }
+
+  void set_to(std::string_view suffix) {
+    b_.replace(static_cast<std::size_t>(j_ + 1), static_cast<std::size_t>(k_ - j_), suffix);
+    k_ = j_ + static_cast<int>(suffix.size());
+  }
+
+  void replace_if_measured(std::string_view suffix) {
+    if (measure() > 0) {
+      set_to(suffix);
+    }
+  }
+
+  // Plurales y participios: -sses, -ies, -s, -eed, -ed, -ing.
+  void step1ab() {
+    if (b_[k_] == 's') {
+      if (ends("sses")) {
+        k_ -= 2;
+      } else if (ends("ies")) {
+        set_to("i");
+      } else if (b_[k_ - 1] != 's') {
+        --k_;
+      }
+    }
+    if (ends("eed")) {
+      if (measure() > 0) {
+        --k_;
+      }
+    } else if ((ends("ed") || ends("ing")) && vowel_in_stem()) {
+      k_ = j_;
+      if (ends("at")) {
+        set_to("ate");
+      } else if (ends("bl")) {
+        set_to("ble");
+      } else if (ends("iz")) {
+        set_to("ize");
+      } else if (double_consonant(k_)) {
+        --k_;
+        if (b_[k_] == 'l' || b_[k_] == 's' || b_[k_] == 'z') {
+          ++k_;
+        }
+      } else if (measure() == 1 && cvc(k_)) {
+        set_to("e");
+      }
+    }
+  }
+
+  // -y final a -i cuando la raíz tiene vocal.
+  void step1c() {
+    if (ends("y") && vowel_in_stem()) {
+      b_[k_] = 'i';
+    }
+  }
+
+  // Sufijos dobles a uno simple (-ization -> -ize, -ational -> -ate, ...).
+  void step2() {
+    switch (b_[k_ - 1]) {
+      case 'a':
+        if (ends("ational")) {
+          replace_if_measured("ate");
+        } else if (ends("tional")) {
+          replace_if_measured("tion");
+        }
+        break;
+      case 'c':
+        if (ends("enci")) {
+          replace_if_measured("ence");
+        } else if (ends("anci")) {
+          replace_if_measured("ance");
+        }
+        break;
+      case 'e':
+        if (ends("izer")) {
+          replace_if_measured("ize");
+        }
+        break;
+      case 'l':
+        if (ends("bli")) {
+          replace_if_measured("ble");
+        } else if (ends("alli")) {
+          replace_if_measured("al");
+        } else if (ends("entli")) {
+          replace_if_measured("ent");
+        } else if (ends("eli")) {
+          replace_if_measured("e");
+        } else if (ends("ousli")) {
+          replace_if_measured("ous");
+        }
+        break;
+      case 'o':
+        if (ends("ization")) {
+          replace_if_measured("ize");
+        } else if (ends("ation")) {
+          replace_if_measured("ate");
+        } else if (ends("ator")) {
+          replace_if_measured("ate");
+        }
+        break;
+      case 's':
+        if (ends("alism")) {
+          replace_if_measured("al");
+        } else if (ends("iveness")) {
+          replace_if_measured("ive");
+        } else if (ends("fulness")) {
+          replace_if_measured("ful");
+        } else if (ends("ousness")) {
+          replace_if_measured("ous");
+        }
+        break;
+      case 't':
+        if (ends("aliti")) {
+          replace_if_measured("al");
+        } else if (ends("iviti")) {
+          replace_if_measured("ive");
+        } else if (ends("biliti")) {
+          replace_if_measured("ble");
+        }
+        break;
+      case 'g':
+        if (ends("logi")) {
+          replace_if_measured("log");
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  // -ic-, -full, -ness, etc.
+  void step3() {
+    switch (b_[k_]) {
+      case 'e':
+        if (ends("icate")) {
+          replace_if_measured("ic");
+        } else if (ends("ative")) {
+          replace_if_measured("");
+        } else if (ends("alize")) {
+          replace_if_measured("al");
+        }
+        break;
+      case 'i':
+        if (ends("iciti")) {
+          replace_if_measured("ic");
+        }
+        break;
+      case 'l':
+        if (ends("ical")) {
+          replace_if_measured("ic");
+        } else if (ends("ful")) {
+          replace_if_measured("");
+        }
+        break;
+      case 's':
+        if (ends("ness")) {
+          replace_if_measured("");
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  // -ant, -ence, etc. cuando la raíz mide más de 1.
+  void step4() {
+    if (k_ < 1) {
+      return;
+    }
+    bool found = false;
+    switch (b_[k_ - 1]) {
+      case 'a':
+        found = ends("al");
+        break;
+      case 'c':
+        found = ends("ance") || ends("ence");
+        break;
+      case 'e':
+        found = ends("er");
+        break;
+      case 'i':
+        found = ends("ic");
+        break;
+      case 'l':
+        found = ends("able") || ends("ible");
+        break;
+      case 'n':
+        found = ends("ant") || ends("ement") || ends("ment") || ends("ent");
+        break;
+      case 'o':
+        found = (ends("ion") && j_ >= 0 && (b_[j_] == 's' || b_[j_] == 't')) || ends("ou");
+        break;
+      case 's':
+        found = ends("ism");
+        break;
+      case 't':
+        found = ends("ate") || ends("iti");
+        break;
+      case 'u':
+        found = ends("ous");
+        break;
+      case 'v':
+        found = ends("ive");
+        break;
+      case 'z':
+        found = ends("ize");
+        break;
+      default:
+        break;
+    }
+    if (found && measure() > 1) {
+      k_ = j_;
+    }
+  }
+
+  // -e final y -ll cuando la raíz mide más de 1.
+  void step5() {
+    j_ = k_;
+    if (b_[k_] == 'e') {
+      const int m = measure();
+      if (m > 1 || (m == 1 && !cvc(k_ - 1))) {
+        --k_;
+      }
+    }
+    if (b_[k_] == 'l' && double_consonant(k_) && measure() > 1) {
+      --k_;
+    }
+  }
+
+  std::string b_;
+  int k_ = 0;
+  int j_ = 0;
+};
+
+bool is_ascii(std::string_view word) {
+  for (unsigned char c : word) {
+    if (c >= 0x80) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ---- Snowball para español ----------------------------------------------------------------
+// Se trabaja sobre code points para que las vocales acentuadas cuenten como una letra.
+
+using Suffixes = std::initializer_list<std::u32string_view>;
+
+bool ends_with(const std::u32string& word, std::u32string_view suffix) {
+  return word.size() >= suffix.size() &&
+         word.compare(word.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Sufijo más largo de la lista que termina la palabra y empieza en `limit` o después; vacío si
+// no hay ninguno.
+std::u32string_view longest_suffix(const std::u32string& word, Suffixes suffixes,
+                                   std::size_t limit = 0) {
+  std::u32string_view best;
+  for (const std::u32string_view suffix : suffixes) {
+    if (suffix.size() > best.size() && word.size() >= limit + suffix.size() &&
+        ends_with(word, suffix)) {
+      best = suffix;
+    }
+  }
+  return best;
+}
+
+bool is_spanish_vowel(char32_t c) {
+  switch (c) {
+    case U'a':
+    case U'e':
+    case U'i':
+    case U'o':
+    case U'u':
+    case U'á':
+    case U'é':
+    case U'í':
+    case U'ó':
+    case U'ú':
+    case U'ü':
+      return true;
+    default:
+      return false;
+  }
+}
+
+class SpanishStemmer {
+ public:
+  explicit SpanishStemmer(const std::u32string& word) : w_(word) { mark_regions(); }
+
+  std::u32string run() {
+    attached_pronoun();
+    if (!standard_suffix() && !y_verb_suffix()) {
+      verb_suffix();
+    }
+    residual_suffix();
+    for (char32_t& c : w_) {
+      switch (c) {
+        case U'á':
+          c = U'a';
+          break;
+        case U'é':
+          c = U'e';
+          break;
+        case U'í':
+          c = U'i';
+          break;
+        case U'ó':
+          c = U'o';
+          break;
+        case U'ú':
+          c = U'u';
+          break;
+        default:
+          break;
+      }
+    }
+    return w_;
+  }
+
+ private:
+  // Posición después de la primera consonante que sigue a una vocal, buscando desde `start`.
+  std::size_t after_vowel_consonant(std::size_t start) const {
+    for (std::size_t i = start + 1; i < w_.size(); ++i) {
+      if (!is_spanish_vowel(w_[i]) && is_spanish_vowel(w_[i - 1])) {
+        return i + 1;
+      }
+    }
+    return w_.size();
+  }
+
+  // RV, R1 y R2 como los define Snowball.
+  void mark_regions() {
+    const std::size_t size = w_.size();
+    rv_ = size;
+    if (size >= 2) {
+      if (!is_spanish_vowel(w_[1])) {
+        // Segunda letra consonante: después de la siguiente vocal.
+        for (std::size_t i = 2; i < size; ++i) {
+          if (is_spanish_vowel(w_[i])) {
+            rv_ = i + 1;
+            break;
+          }
+        }
+      } else if (is_spanish_vowel(w_[0])) {
+        // Dos vocales al inicio: después de la siguiente consonante.
+        for (std::size_t i = 2; i < size; ++i) {
+          if (!is_spanish_vowel(w_[i])) {
+            rv_ = i + 1;
+            break;
+          }
+        }
+      } else if (size >= 3) {
+        rv_ = 3;  // Consonante y vocal: después de la tercera letra.
+      }
+    }
+    r1_ = after_vowel_consonant(0);
+    r2_ = r1_ < size ? after_vowel_consonant(r1_) : size;
+  }
+
+  std::size_t start_of(std::u32string_view suffix) const { return w_.size() - suffix.size(); }
+
+  void erase(std::u32string_view suffix) { w_.resize(start_of(suffix)); }
+
+  void replace(std::u32string_view suffix, std::u32string_view replacement) {
+    w_.replace(start_of(suffix), suffix.size(), replacement);
+  }
+
+  // Borra el sufijo si empieza en `region` o después.
+  bool erase_in(std::u32string_view suffix, std::size_t region) {
+    if (suffix.empty() || !ends_with(w_, suffix) || start_of(suffix) < region) {
+      return false;
+    }
+    erase(suffix);
+    return true;
+  }
+
+  // Paso 0: pronombre enclítico después de gerundio o infinitivo (dándoselo -> dando).
+  void attached_pronoun() {
+    const std::u32string_view pronoun =
+        longest_suffix(w_, {U"me", U"se", U"sela", U"selo", U"selas", U"selos", U"la", U"le",
+                            U"lo", U"las", U"les", U"los", U"nos"});
+    if (pronoun.empty() || start_of(pronoun) < rv_) {
+      return;
+    }
+    const std::u32string stem = w_.substr(0, start_of(pronoun));
+    const std::u32string_view before =
+        longest_suffix(stem, {U"iéndo", U"ándo", U"ár", U"ér", U"ír", U"ando", U"iendo", U"ar",
+                              U"er", U"ir", U"yendo"});
+    if (before.empty()) {
+      return;
+    }
+    if (before == U"yendo" && !ends_with(stem.substr(0, stem.size() - before.size()), U"u")) {
+      return;
+    }
+    w_ = stem;
+    if (before == U"iéndo") {
+      replace(before, U"iendo");
+    } else if (before == U"ándo") {
+      replace(before, U"ando");
+    } else if (before == U"ár") {
+      replace(before, U"ar");
+    } else if (before == U"ér") {
+      replace(before, U"er");
+    } else if (before == U"ír") {
+      replace(before, U"ir");
+    }
+  }
+
+  // Paso 1: sufijos derivativos. Regresa true si quitó alguno.
+  bool standard_suffix() {
+    const std::u32string_view suffix = longest_suffix(
+        w_, {U"anza", U"anzas", U"ico", U"ica", U"icos", U"icas", U"ismo", U"ismos", U"able",
+             U"ables", U"ible", U"ibles", U"ista", U"istas", U"oso", U"osa", U"osos", U"osas",
+             U"amiento", U"amientos", U"imiento", U"imientos", U"adora", U"ador", U"ación",
+             U"adoras", U"adores", U"aciones", U"ante", U"antes", U"ancia", U"ancias",
+             U"logía", U"logías", U"ución", U"uciones", U"encia", U"encias", U"amente",
+             U"mente", U"idad", U"idades", U"iva", U"ivo", U"ivas", U"ivos"});
+    if (suffix.empty()) {
+      return false;
+    }
+    const auto one_of = [&](Suffixes group) {
+      for (const std::u32string_view candidate : group) {
+        if (suffix == candidate) {
+          return true;
+        }
+      }
+      return false;
+    };
+
+    if (suffix == U"amente") {
+      if (!erase_in(suffix, r1_)) {
+        return false;
+      }
+      const std::u32string_view after = longest_suffix(w_, {U"iv", U"os", U"ic", U"ad"});
+      if (erase_in(after, r2_) && after == U"iv") {
+        erase_in(U"at", r2_);
+      }
+      return true;
+    }
+    if (start_of(suffix) < r2_) {
+      return false;
+    }
+    if (one_of({U"adora", U"ador", U"ación", U"adoras", U"adores", U"aciones", U"ante",
+                U"antes", U"ancia", U"ancias"})) {
+      erase(suffix);
+      erase_in(U"ic", r2_);
+    } else if (one_of({U"logía", U"logías"})) {
+      replace(suffix, U"log");
+    } else if (one_of({U"ución", U"uciones"})) {
+      replace(suffix, U"u");
+    } else if (one_of({U"encia", U"encias"})) {
+      replace(suffix, U"ente");
+    } else if (suffix == U"mente") {
+      erase(suffix);
+      erase_in(longest_suffix(w_, {U"ante", U"able", U"ible"}), r2_);
+    } else if (one_of({U"idad", U"idades"})) {
+      erase(suffix);
+      erase_in(longest_suffix(w_, {U"abil", U"ic", U"iv"}), r2_);
+    } else if (one_of({U"iva", U"ivo", U"ivas", U"ivos"})) {
+      erase(suffix);
+      erase_in(U"at", r2_);
+    } else {
+      erase(suffix);
+    }
+    return true;
+  }
+
+  // Paso 2a: sufijos verbales que empiezan con y, solo después de u (construyendo -> constru).
+  bool y_verb_suffix() {
+    const std::u32string_view suffix =
+        longest_suffix(w_, {U"ya", U"ye", U"yan", U"yen", U"yeron", U"yendo", U"yo", U"yó",
+                            U"yas", U"yes", U"yais", U"yamos"},
+                       rv_);
+    if (suffix.empty() || start_of(suffix) == 0 || w_[start_of(suffix) - 1] != U'u') {
+      return false;
+    }
+    erase(suffix);
+    return true;
+  }
+
+  // Paso 2b: el resto de las terminaciones verbales dentro de RV.
+  void verb_suffix() {
+    const std::u32string_view suffix = longest_suffix(
+        w_, {U"en", U"es", U"éis", U"emos",
+             U"arían", U"arías", U"arán", U"arás", U"aríais", U"aría", U"aréis", U"aríamos",
+             U"aremos", U"ará", U"aré", U"erían", U"erías", U"erán", U"erás", U"eríais", U"ería",
+             U"eréis", U"eríamos", U"eremos", U"erá", U"eré", U"irían", U"irías", U"irán",
+             U"irás", U"iríais", U"iría", U"iréis", U"iríamos", U"iremos", U"irá", U"iré",
+             U"aba", U"ada", U"ida", U"ía", U"ara", U"iera", U"ad", U"ed", U"id", U"ase",
+             U"iese", U"aste", U"iste", U"an", U"aban", U"ían", U"aran", U"ieran", U"asen",
+             U"iesen", U"aron", U"ieron", U"ado", U"ido", U"ando", U"iendo", U"ió", U"ar",
+             U"er", U"ir", U"as", U"abas", U"adas", U"idas", U"ías", U"aras", U"ieras",
+             U"ases", U"ieses", U"ís", U"áis", U"abais", U"íais", U"arais", U"ierais",
+             U"aseis", U"ieseis", U"asteis", U"isteis", U"ados", U"idos", U"amos", U"ábamos",
+             U"íamos", U"imos", U"áramos", U"iéramos", U"iésemos", U"ásemos"},
+        rv_);
+    if (suffix.empty()) {
+      return;
+    }
+    const bool drops_gu_u =
+        suffix == U"en" || suffix == U"es" || suffix == U"éis" || suffix == U"emos";
+    erase(suffix);
+    if (drops_gu_u && ends_with(w_, U"gu")) {
+      w_.pop_back();
+    }
+  }
+
+  // Paso 3: vocal residual (y la u de -gue) dentro de RV.
+  void residual_suffix() {
+    const std::u32string_view suffix =
+        longest_suffix(w_, {U"os", U"a", U"o", U"á", U"í", U"ó", U"e", U"é"});
+    if (suffix.empty() || start_of(suffix) < rv_) {
+      return;
+    }
+    erase(suffix);
+    if ((suffix == U"e" || suffix == U"é") && ends_with(w_, U"gu") && w_.size() - 1 >= rv_) {
+      w_.pop_back();
+    }
+  }
+
+  std::u32string w_;
+  std::size_t rv_ = 0;
+  std::size_t r1_ = 0;
+  std::size_t r2_ = 0;
+};
+
+// Decodifica UTF-8 (el tokenizador solo deja secuencias válidas). Regresa false si encuentra
+// una inválida.
+bool decode_utf8(std::string_view text, std::u32string& out) {
+  out.clear();
+  for (std::size_t i = 0; i < text.size();) {
+    const unsigned char lead = static_cast<unsigned char>(text[i]);
+    std::size_t length = 1;
+    char32_t cp = lead;
+    if (lead >= 0xF0) {
+      length = 4;
+      cp = lead & 0x07;
+    } else if (lead >= 0xE0) {
+      length = 3;
+      cp = lead & 0x0F;
+    } else if (lead >= 0xC0) {
+      length = 2;
+      cp = lead & 0x1F;
+    } else if (lead >= 0x80) {
+      return false;
+    }
+    if (i + length > text.size()) {
+      return false;
+    }
+    for (std::size_t k = 1; k < length; ++k) {
+      const unsigned char byte = static_cast<unsigned char>(text[i + k]);
+      if ((byte & 0xC0) != 0x80) {
+        return false;
+      }
+      cp = (cp << 6) | (byte & 0x3F);
+    }
+    out.push_back(cp);
+    i += length;
+  }
+  return true;
+}
+
+std::string encode_utf8(const std::u32string& text) {
+  std::string out;
+  out.reserve(text.size() + 4);
+  for (const char32_t cp : text) {
+    if (cp < 0x80) {
+      out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+      out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+      out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+namespace bow {
+
+bool parse_stemmer_language(const std::string& name, StemmerLanguage& language) {
+  if (name == "en") {
+    language = StemmerLanguage::kEnglish;
+  } else if (name == "es") {
+    language = StemmerLanguage::kSpanish;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string stem_word(std::string_view word, StemmerLanguage language) {
+  switch (language) {
+    case StemmerLanguage::kEnglish:
+      return is_ascii(word) ? PorterStemmer(word).run() : std::string(word);
+    case StemmerLanguage::kSpanish: {
+      std::u32string letters;
+      if (!decode_utf8(word, letters)) {
+        return std::string(word);
+      }
+      return encode_utf8(SpanishStemmer(letters).run());
+    }
+    case StemmerLanguage::kNone:
+      break;
+  }
+  return std::string(word);
+}
+
+}  // namespace bow
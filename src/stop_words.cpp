@@ -0,0 +1,224 @@
+// stop_words.cpp: Listas integradas de palabras vacías y construcción del hash perfecto.
+#include "bow/stop_words.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+namespace {
+
+// Lista de NLTK para inglés, sin las contracciones con apóstrofo (el tokenizador ya las
+// parte: "don't" llega como "don" y "t", que sí están).
+constexpr std::string_view kEnglishStopWords[] = {
+    "i", "me", "my", "myself", "we", "our", "ours", "ourselves", "you", "your", "yours",
+    "yourself", "yourselves", "he", "him", "his", "himself", "she", "her", "hers", "herself",
+    "it", "its", "itself", "they", "them", "their", "theirs", "themselves", "what", "which",
+    "who", "whom", "this", "that", "these", "those", "am", "is", "are", "was", "were", "be",
+    "been", "being", "have", "has", "had", "having", "do", "does", "did", "doing", "a", "an",
+    "the", "and", "but", "if", "or", "because", "as", "until", "while", "of", "at", "by",
+    "for", "with", "about", "against", "between", "into", "through", "during", "before",
+    "after", "above", "below", "to", "from", "up", "down", "in", "out", "on", "off", "over",
+    "under", "again", "further", "then", "once", "here", "there", "when", "where", "why",
+    "how", "all", "any", "both", "each", "few", "more", "most", "other", "some", "such", "no",
+    "nor", "not", "only", "own", "same", "so", "than", "too", "very", "s", "t", "can", "will",
+    "just", "don", "should", "now", "d", "ll", "m", "o", "re", "ve", "y", "ain", "aren",
+    "couldn", "didn", "doesn", "hadn", "hasn", "haven", "isn", "ma", "mightn", "mustn",
+    "needn", "shan", "shouldn", "wasn", "weren", "won", "wouldn",
+};
+
+// Lista de NLTK para español. Las palabras acentuadas solo se aplican con --tokenizer utf8.
+constexpr std::string_view kSpanishStopWords[] = {
+    "de", "la", "que", "el", "en", "y", "a", "los", "del", "se", "las", "por", "un", "para",
+    "con", "no", "una", "su", "al", "lo", "como", "más", "pero", "sus", "le", "ya", "o",
+    "este", "sí", "porque", "esta", "entre", "cuando", "muy", "sin", "sobre", "también", "me",
+    "hasta", "hay", "donde", "quien", "desde", "todo", "nos", "durante", "todos", "uno", "les",
+    "ni", "contra", "otros", "ese", "eso", "ante", "ellos", "e", "esto", "mí", "antes",
+    "algunos", "qué", "unos", "yo", "otro", "otras", "otra", "él", "tanto", "esa", "estos",
+    "mucho", "quienes", "nada", "muchos", "cual", "poco", "ella", "estar", "estas", "algunas",
+    "algo", "nosotros", "mi", "mis", "tú", "te", "ti", "tu", "tus", "ellas", "nosotras",
+    "vosotros", "vosotras", "os", "mío", "mía", "míos", "mías", "tuyo", "tuya", "tuyos",
+    "tuyas", "suyo", "suya", "suyos", "suyas", "nuestro", "nuestra", "nuestros", "nuestras",
+    "vuestro", "vuestra", "vuestros", "vuestras", "esos", "esas", "estoy", "estás", "está",
+    "estamos", "estáis", "están", "esté", "estés", "estemos", "estéis", "estén", "estaré",
+    "estarás", "estará", "estaremos", "estaréis", "estarán", "estaría", "estarías",
+    "estaríamos", "estaríais", "estarían", "estaba", "estabas", "estábamos", "estabais",
+    "estaban", "estuve", "estuviste", "estuvo", "estuvimos", "estuvisteis", "estuvieron",
+    "estuviera", "estuvieras", "estuviéramos", "estuvierais", "estuvieran", "estuviese",
+    "estuvieses", "estuviésemos", "estuvieseis", "estuviesen", "estando", "estado", "estada",
+    "estados", "estadas", "estad", "he", "has", "ha", "hemos", "habéis", "han", "haya",
+    "hayas", "hayamos", "hayáis", "hayan", "habré", "habrás", "habrá", "habremos", "habréis",
+    "habrán", "habría", "habrías", "habríamos", "habríais", "habrían", "había", "habías",
+    "habíamos", "habíais", "habían", "hube", "hubiste", "hubo", "hubimos", "hubisteis",
+    "hubieron", "hubiera", "hubieras", "hubiéramos", "hubierais", "hubieran", "hubiese",
+    "hubieses", "hubiésemos", "hubieseis", "hubiesen", "habiendo", "habido", "habida",
+    "habidos", "habidas", "soy", "eres", "es", "somos", "sois", "son", "sea", "seas",
+    "seamos", "seáis", "sean", "seré", "serás", "será", "seremos", "seréis", "serán", "sería",
+    "serías", "seríamos", "seríais", "serían", "era", "eras", "éramos", "erais", "eran", "fui",
+    "fuiste", "fue", "fuimos", "fuisteis", "fueron", "fuera", "fueras", "fuéramos", "fuerais",
+    "fueran", "fuese", "fueses", "fuésemos", "fueseis", "fuesen", "sintiendo", "sentido",
+    "sentida", "sentidos", "sentidas", "siente", "sentid", "tengo", "tienes", "tiene",
+    "tenemos", "tenéis", "tienen", "tenga", "tengas", "tengamos", "tengáis", "tengan",
+    "tendré", "tendrás", "tendrá", "tendremos", "tendréis", "tendrán", "tendría", "tendrías",
+    "tendríamos", "tendríais", "tendrían", "tenía", "tenías", "teníamos", "teníais", "tenían",
+    "tuve", "tuviste", "tuvo", "tuvimos", "tuvisteis", "tuvieron", "tuviera", "tuvieras",
+    "tuviéramos", "tuvierais", "tuvieran", "tuviese", "tuvieses", "tuviésemos", "tuvieseis",
+    "tuviesen", "teniendo", "tenido", "tenida", "tenidos", "tenidas", "tened",
+};
+
+// Intentos de desplazamiento por cubeta antes de agrandar la tabla.
+constexpr std::uint32_t kMaxDisplacement = 1 << 16;
+
+std::uint64_t next_power_of_two(std::uint64_t value) {
+  std::uint64_t power = 1;
+  while (power < value) {
+    power <<= 1;
+  }
+  return power;
+}
+
+// Normaliza una palabra de la lista como lo haría el tokenizador. Regresa false si con ese
+// criterio no sería exactamente un token.
+bool normalize_word(std::string_view word, bow::TokenizerMode mode, std::string& normalized) {
+  normalized.clear();
+  bool split = false;
+  const std::size_t consumed = bow::scan_characters(
+      word.data(), word.size(), mode,
+      [&](std::size_t, const char* bytes, std::size_t size) {
+        normalized.append(bytes, size);
+        return true;
+      },
+      [&](std::size_t) {
+        split = true;
+        return false;
+      });
+  return !split && consumed == word.size() && !normalized.empty();
+}
+
+}  // namespace
+
+namespace bow {
+
+StopWords::StopWords(std::vector<std::string> words) {
+  words.erase(std::remove(words.begin(), words.end(), std::string()), words.end());
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+  // Dos palabras con el mismo hash nunca caerían en casillas distintas. Es prácticamente
+  // imposible, pero si pasa se conserva solo la primera en vez de reintentar sin fin.
+  std::vector<std::pair<std::uint64_t, std::size_t>> keys(words.size());
+  for (std::size_t w = 0; w < words.size(); ++w) {
+    keys[w] = {key_of(words[w]), w};
+  }
+  std::sort(keys.begin(), keys.end());
+  for (std::size_t k = 1; k < keys.size(); ++k) {
+    if (keys[k].first == keys[k - 1].first) {
+      std::cerr << "Advertencia: se omite la palabra vacía " << words[keys[k].second]
+                << " (choca con " << words[keys[k - 1].second] << ")" << std::endl;
+      words[keys[k].second].clear();
+    }
+  }
+  words.erase(std::remove(words.begin(), words.end(), std::string()), words.end());
+  size_ = words.size();
+  for (const auto& word : words) {
+    const std::size_t bit = filter_bit(word);
+    filter_[bit / 64] |= std::uint64_t{1} << (bit % 64);
+  }
+
+  // Carga de la tabla <= 1/2 y ~2 palabras por cubeta: el desplazamiento se encuentra en
+  // pocos intentos. Si alguna cubeta no cabe, se duplica la tabla y se vuelve a intentar.
+  bucket_mask_ = next_power_of_two(std::max<std::size_t>(1, size_ / 2)) - 1;
+  slot_mask_ = next_power_of_two(std::max<std::size_t>(2, 2 * size_)) - 1;
+  while (!place(words)) {
+    slot_mask_ = slot_mask_ * 2 + 1;
+  }
+}
+
+bool StopWords::place(const std::vector<std::string>& words) {
+  std::vector<std::vector<std::size_t>> buckets(bucket_mask_ + 1);
+  std::vector<std::uint64_t> hashes(words.size());
+  for (std::size_t w = 0; w < words.size(); ++w) {
+    hashes[w] = key_of(words[w]);
+    buckets[hashes[w] & bucket_mask_].push_back(w);
+  }
+  // Primero las cubetas más llenas, cuando la tabla todavía tiene más casillas libres.
+  std::vector<std::size_t> order(buckets.size());
+  for (std::size_t b = 0; b < order.size(); ++b) {
+    order[b] = b;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t left, std::size_t right) {
+    return buckets[left].size() > buckets[right].size();
+  });
+
+  slots_.assign(slot_mask_ + 1, std::string());
+  displacements_.assign(buckets.size(), 0);
+  std::vector<std::size_t> candidate;
+  for (const std::size_t b : order) {
+    if (buckets[b].empty()) {
+      break;
+    }
+    bool placed = false;
+    for (std::uint32_t displacement = 0; displacement < kMaxDisplacement && !placed;
+         ++displacement) {
+      candidate.clear();
+      placed = true;
+      for (const std::size_t w : buckets[b]) {
+        const std::size_t slot = slot_of(hashes[w], displacement);
+        if (!slots_[slot].empty() ||
+            std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+          placed = false;
+          break;
+        }
+        candidate.push_back(slot);
+      }
+      if (placed) {
+        displacements_[b] = displacement;
+        for (std::size_t k = 0; k < candidate.size(); ++k) {
+          slots_[candidate[k]] = words[buckets[b][k]];
+        }
+      }
+    }
+    if (!placed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::shared_ptr<const StopWords> load_stop_words(const std::vector<std::string>& sources,
+                                                 TokenizerMode mode) {
+  std::vector<std::string> words;
+  std::string normalized;
+  const auto add = [&](std::string_view word) {
+    if (normalize_word(word, mode, normalized)) {
+      words.push_back(normalized);
+    }
+  };
+
+  for (const auto& source : sources) {
+    if (source == "en") {
+      std::for_each(std::begin(kEnglishStopWords), std::end(kEnglishStopWords), add);
+      continue;
+    }
+    if (source == "es") {
+      std::for_each(std::begin(kSpanishStopWords), std::end(kSpanishStopWords), add);
+      continue;
+    }
+    std::ifstream input(source);
+    if (!input.is_open()) {
+      std::cerr << "No se pudo abrir la lista de palabras vacías: " << source << std::endl;
+      return nullptr;
+    }
+    std::string line;
+    while (std::getline(input, line)) {
+      std::istringstream fields(line.substr(0, line.find('#')));
+      std::string word;
+      while (fields >> word) {
+        add(word);
+      }
+    }
+  }
+  return std::make_shared<const StopWords>(std::move(words));
+}
+
+}  // namespace bow
@@ -0,0 +1,210 @@
+// streaming.cpp: Conteo de tokens por bloques sin materializar el documento ni la lista de tokens.
+#include "bow/streaming.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "bow/core.hpp"
+#include "bow/stop_words.hpp"
+
+namespace {
+
+// Una secuencia UTF-8 ocupa a lo más 4 bytes: lo que se arrastra de un bloque al siguiente por
+// quedar cortado nunca pasa de 3.
+constexpr std::size_t kMaxCarryBytes = 3;
+
+std::size_t block_bytes(std::size_t block_size) {
+  // Siempre cabe al menos un byte nuevo detrás del arrastre.
+  return std::max(block_size > 0 ? block_size : bow::kDefaultStreamBlockBytes,
+                  kMaxCarryBytes + 1);
+}
+
+bool is_stop_word(const bow::TokenizerOptions& options, const std::string& token) {
+  return options.stop_words != nullptr && options.stop_words->contains(token);
+}
+
+// Cuenta el token que se acaba de cerrar, salvo que sea una palabra vacía.
+void count_token(const bow::TokenizerOptions& options, const std::string& token,
+                 bow::WordCounter& counter) {
+  if (!is_stop_word(options, token)) {
+    counter.add(token);
+  }
+}
+
+}  // namespace
+
+namespace bow {
+
+bool stream_count_document(const std::string& path, std::size_t block_size,
+                           const TokenizerOptions& options, WordCounter& counter,
+                           WordCounts& word_counts) {
+  std::ifstream input(path, std::ios::binary);
+  if (!input.is_open()) {
+    std::cerr << "No se pudo abrir el archivo: " << path << std::endl;
+    return false;
+  }
+
+  std::vector<char> block(block_bytes(block_size));
+  std::string current_token;  // Sobrevive entre bloques: es el arrastre del token partido.
+  std::size_t carry = 0;      // Bytes de un carácter UTF-8 partido, al inicio del bloque.
+  std::size_t total_bytes = 0;
+
+  const auto on_char = [&](std::size_t, const char* bytes, std::size_t size) {
+    current_token.append(bytes, size);
+    return true;
+  };
+  const auto on_delimiter = [&](std::size_t) {
+    if (!current_token.empty()) {
+      count_token(options, current_token, counter);
+      current_token.clear();
+    }
+    return true;
+  };
+
+  while (input) {
+    input.read(block.data() + carry, static_cast<std::streamsize>(block.size() - carry));
+    const std::size_t bytes_read = static_cast<std::size_t>(input.gcount());
+    if (bytes_read == 0) {
+      break;
+    }
+    total_bytes += bytes_read;
+
+    const std::size_t available = carry + bytes_read;
+    const std::size_t consumed =
+        scan_characters(block.data(), available, options.mode, on_char, on_delimiter);
+    carry = available - consumed;
+    std::copy(block.data() + consumed, block.data() + available, block.data());
+  }
+
+  // Un carácter que quedó incompleto al final del archivo cuenta como delimitador.
+  on_delimiter(0);
+  word_counts = counter.finish();
+  return total_bytes > 0;
+}
+
+bool stream_count_range(const std::string& path, std::uint64_t begin, std::uint64_t end,
+                        std::size_t block_size, const TokenizerOptions& options,
+                        WordCounter& counter, WordCounts& word_counts) {
+  std::ifstream input(path, std::ios::binary);
+  if (!input.is_open()) {
+    std::cerr << "No se pudo abrir el archivo: " << path << std::endl;
+    return false;
+  }
+
+  // Si el carácter anterior al trozo es parte de un token, ese token es del trozo anterior; un
+  // carácter UTF-8 cortado por `begin` también lo es. Para ubicar los inicios de carácter se
+  // decodifica una ventana desde unos bytes antes, después de saltar las continuaciones con las
+  // que empiece (pertenecen a un carácter que termina antes de `begin`).
+  std::uint64_t position = begin;  // Primer carácter del trozo.
+  bool skipping = false;
+  if (begin > 0) {
+    constexpr std::size_t kWindowSide = kMaxCarryBytes + 1;
+    const std::uint64_t window_begin = begin > kWindowSide ? begin - kWindowSide : 0;
+    char window[2 * kWindowSide];
+    input.seekg(static_cast<std::streamoff>(window_begin));
+    input.read(window, static_cast<std::streamsize>(begin - window_begin + kWindowSide));
+    const std::size_t window_size = static_cast<std::size_t>(input.gcount());
+    if (window_begin + window_size < begin) {
+      return true;  // El trozo empieza después del final del archivo.
+    }
+
+    std::size_t first = 0;
+    if (options.mode == TokenizerMode::kUtf8) {
+      while (first < window_size && (static_cast<unsigned char>(window[first]) & 0xC0) == 0x80) {
+        ++first;
+      }
+    }
+    bool found = false;
+    const auto classify = [&](std::size_t offset, bool token_char) {
+      const std::uint64_t at = window_begin + first + offset;
+      if (at >= begin) {
+        position = at;
+        found = true;
+        return false;
+      }
+      skipping = token_char;
+      return true;
+    };
+    const std::size_t consumed = scan_characters(
+        window + first, window_size - first, options.mode,
+        [&](std::size_t offset, const char*, std::size_t) { return classify(offset, true); },
+        [&](std::size_t offset) { return classify(offset, false); });
+    if (!found) {
+      // La ventana terminó (fin de archivo o carácter incompleto) antes de otro carácter.
+      position = window_begin + first + consumed;
+    }
+    input.clear();
+    input.seekg(static_cast<std::streamoff>(position));
+  }
+
+  std::vector<char> block(block_bytes(block_size));
+  std::string current_token;
+  std::size_t carry = 0;
+  std::uint64_t block_position = position;  // Posición en el archivo de block[0].
+  bool stopped = false;
+  // Pasado el final, los n-gramas que empezaron en el trozo todavía necesitan los siguientes
+  // tokens: se leen sin contarlos (add_trailing) y el resto queda para el siguiente trozo.
+  bool trailing = false;
+  std::size_t trailing_left = counter.trailing_tokens();
+
+  // Pasamos el final y no hay token abierto (ni n-grama por completar): el resto es del
+  // siguiente.
+  const auto past_end = [&](std::size_t offset) {
+    trailing = trailing || (block_position + offset >= end && current_token.empty());
+    stopped = trailing && trailing_left == 0;
+    return stopped;
+  };
+  const auto close_token = [&] {
+    if (!trailing) {
+      count_token(options, current_token, counter);
+    } else if (!is_stop_word(options, current_token)) {
+      counter.add_trailing(current_token);
+      --trailing_left;
+    }
+    current_token.clear();
+  };
+  const auto on_char = [&](std::size_t offset, const char* bytes, std::size_t size) {
+    if (skipping) {
+      return true;
+    }
+    if (past_end(offset)) {
+      return false;
+    }
+    current_token.append(bytes, size);
+    return true;
+  };
+  const auto on_delimiter = [&](std::size_t offset) {
+    skipping = false;
+    if (past_end(offset)) {
+      return false;
+    }
+    if (!current_token.empty()) {
+      close_token();
+    }
+    return true;
+  };
+
+  while (!stopped && input) {
+    input.read(block.data() + carry, static_cast<std::streamsize>(block.size() - carry));
+    const std::size_t bytes_read = static_cast<std::size_t>(input.gcount());
+    if (bytes_read == 0) {
+      break;
+    }
+    const std::size_t available = carry + bytes_read;
+    const std::size_t consumed =
+        scan_characters(block.data(), available, options.mode, on_char, on_delimiter);
+    carry = available - consumed;
+    std::copy(block.data() + consumed, block.data() + available, block.data());
+    block_position += consumed;
+  }
+
+  if (!current_token.empty()) {
+    close_token();
+  }
+  word_counts = counter.finish();
+  return true;
+}
+
+}  // namespace bow
@@ -0,0 +1,190 @@
+// symbol_table.cpp: Tabla de símbolos por rank y caché por hilo (direccionamiento abierto).
+#include "bow/symbol_table.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace {
+
+constexpr std::size_t kInitialSlots = 1024;  // Potencia de 2.
+
+}  // namespace
+
+namespace bow {
+
+SymbolTable::SymbolTable()
+    : arena_(64 * 1024), slots_(kInitialSlots, kNoSymbol), ngram_slots_(kInitialSlots, kNoSymbol) {}
+
+Symbol SymbolTable::intern(std::string_view word, std::uint64_t hash) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::size_t mask = slots_.size() - 1;
+  std::size_t slot = hash & mask;
+  while (slots_[slot] != kNoSymbol) {
+    const SymbolId id = slots_[slot];
+    if (hashes_[id] == hash && words_[id] == word) {
+      return {id, words_[id]};
+    }
+    slot = (slot + 1) & mask;
+  }
+  const Symbol symbol{static_cast<SymbolId>(words_.size()), arena_.store(word)};
+  words_.push_back(symbol.word);
+  hashes_.push_back(hash);
+  slots_[slot] = symbol.id;
+  if (++num_words_ * 2 > slots_.size()) {
+    grow();
+  }
+  return symbol;
+}
+
+SymbolId SymbolTable::intern_ngram(const NgramKey& key, std::uint64_t hash) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::size_t mask = ngram_slots_.size() - 1;
+  std::size_t slot = hash & mask;
+  while (ngram_slots_[slot] != kNoSymbol) {
+    const std::uint32_t index = ngram_slots_[slot];
+    if (ngram_hashes_[index] == hash && ngram_keys_[index] == key) {
+      return ngram_ids_[index];
+    }
+    slot = (slot + 1) & mask;
+  }
+  const SymbolId id = static_cast<SymbolId>(words_.size());
+  words_.emplace_back();
+  hashes_.push_back(hash);
+  ngram_slots_[slot] = static_cast<std::uint32_t>(ngram_keys_.size());
+  ngram_keys_.push_back(key);
+  ngram_ids_.push_back(id);
+  ngram_hashes_.push_back(hash);
+  if (ngram_keys_.size() * 2 > ngram_slots_.size()) {
+    grow_ngrams();
+  }
+  return id;
+}
+
+void SymbolTable::materialize_ngrams() {
+  std::string text;
+  for (std::size_t index = materialized_ngrams_; index < ngram_keys_.size(); ++index) {
+    text.clear();
+    for (const SymbolId part : ngram_keys_[index]) {
+      if (part == kNoSymbol) {
+        break;
+      }
+      if (!text.empty()) {
+        text += ' ';
+      }
+      text += words_[part];
+    }
+    words_[ngram_ids_[index]] = arena_.store(text);
+  }
+  materialized_ngrams_ = ngram_keys_.size();
+}
+
+void SymbolTable::grow() {
+  // Se recorre la tabla vieja y no los ids: los ids de n-gramas no viven en slots_.
+  std::vector<SymbolId> slots(slots_.size() * 2, kNoSymbol);
+  const std::size_t mask = slots.size() - 1;
+  for (const SymbolId id : slots_) {
+    if (id == kNoSymbol) {
+      continue;
+    }
+    std::size_t slot = hashes_[id] & mask;
+    while (slots[slot] != kNoSymbol) {
+      slot = (slot + 1) & mask;
+    }
+    slots[slot] = id;
+  }
+  slots_ = std::move(slots);
+}
+
+void SymbolTable::grow_ngrams() {
+  std::vector<std::uint32_t> slots(ngram_slots_.size() * 2, kNoSymbol);
+  const std::size_t mask = slots.size() - 1;
+  for (std::uint32_t index = 0; index < ngram_keys_.size(); ++index) {
+    std::size_t slot = ngram_hashes_[index] & mask;
+    while (slots[slot] != kNoSymbol) {
+      slot = (slot + 1) & mask;
+    }
+    slots[slot] = index;
+  }
+  ngram_slots_ = std::move(slots);
+}
+
+void SymbolTable::sort_by_word(std::vector<SymbolId>& ids) const {
+  std::sort(ids.begin(), ids.end(),
+            [this](SymbolId lhs, SymbolId rhs) { return words_[lhs] < words_[rhs]; });
+}
+
+SymbolCache::SymbolCache(SymbolTable& table) : table_(&table), entries_(kInitialSlots) {}
+
+SymbolId SymbolCache::intern(std::string_view word, std::uint64_t hash) {
+  const std::size_t mask = entries_.size() - 1;
+  std::size_t slot = hash & mask;
+  while (entries_[slot].symbol.id != kNoSymbol) {
+    const Entry& entry = entries_[slot];
+    if (entry.hash == hash && entry.symbol.word == word) {
+      return entry.symbol.id;
+    }
+    slot = (slot + 1) & mask;
+  }
+  const Symbol symbol = table_->intern(word, hash);
+  entries_[slot] = {symbol, hash};
+  if (++used_ * 2 > entries_.size()) {
+    grow();
+  }
+  return symbol.id;
+}
+
+SymbolId SymbolCache::intern_ngram(const NgramKey& key) {
+  if (ngram_entries_.empty()) {
+    ngram_entries_.resize(kInitialSlots);
+  }
+  const std::uint64_t hash = hash_ngram(key);
+  const std::size_t mask = ngram_entries_.size() - 1;
+  std::size_t slot = hash & mask;
+  while (ngram_entries_[slot].id != kNoSymbol) {
+    const NgramEntry& entry = ngram_entries_[slot];
+    if (entry.hash == hash && entry.key == key) {
+      return entry.id;
+    }
+    slot = (slot + 1) & mask;
+  }
+  const SymbolId id = table_->intern_ngram(key, hash);
+  ngram_entries_[slot] = {key, id, hash};
+  if (++ngrams_used_ * 2 > ngram_entries_.size()) {
+    grow_ngrams();
+  }
+  return id;
+}
+
+void SymbolCache::grow() {
+  std::vector<Entry> entries(entries_.size() * 2);
+  const std::size_t mask = entries.size() - 1;
+  for (const Entry& entry : entries_) {
+    if (entry.symbol.id == kNoSymbol) {
+      continue;
+    }
+    std::size_t slot = entry.hash & mask;
+    while (entries[slot].symbol.id != kNoSymbol) {
+      slot = (slot + 1) & mask;
+    }
+    entries[slot] = entry;
+  }
+  entries_ = std::move(entries);
+}
+
+void SymbolCache::grow_ngrams() {
+  std::vector<NgramEntry> entries(ngram_entries_.size() * 2);
+  const std::size_t mask = entries.size() - 1;
+  for (const NgramEntry& entry : ngram_entries_) {
+    if (entry.id == kNoSymbol) {
+      continue;
+    }
+    std::size_t slot = entry.hash & mask;
+    while (entries[slot].id != kNoSymbol) {
+      slot = (slot + 1) & mask;
+    }
+    entries[slot] = entry;
+  }
+  ngram_entries_ = std::move(entries);
+}
+
+}  // namespace bow
@@ -0,0 +1,79 @@
+// tfidf.cpp: Frecuencias de documento por columna, idf y filas ponderadas.
+#include "bow/tfidf.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bow {
+
+bool parse_tfidf_options(const std::string& text, TfidfOptions& options) {
+  TfidfOptions parsed;
+  parsed.enabled = true;
+  std::size_t start = 0;
+  while (start <= text.size()) {
+    const std::size_t comma = std::min(text.find(',', start), text.size());
+    const std::string name = text.substr(start, comma - start);
+    if (name == "sublinear") {
+      parsed.sublinear_tf = true;
+    } else if (name == "nosmooth") {
+      parsed.smooth_idf = false;
+    } else {
+      return false;
+    }
+    start = comma + 1;
+  }
+  options = parsed;
+  return true;
+}
+
+std::vector<std::uint64_t> column_document_frequency(const std::vector<WordCounts>& counts,
+                                                     const std::vector<int>& column_of_symbol,
+                                                     std::size_t columns) {
+  std::vector<std::uint64_t> frequency(columns, 0);
+  for (const auto& document_map : counts) {
+    for (const auto& entry : document_map) {
+      const int column = column_of_symbol[entry.first];
+      if (column >= 0) {
+        ++frequency[column];
+      }
+    }
+  }
+  return frequency;
+}
+
+std::vector<double> inverse_document_frequency(
+    const std::vector<std::uint64_t>& document_frequency, std::uint64_t documents,
+    bool smooth_idf) {
+  const double n = static_cast<double>(documents) + (smooth_idf ? 1.0 : 0.0);
+  std::vector<double> idf(document_frequency.size());
+  for (std::size_t column = 0; column < idf.size(); ++column) {
+    const double df = static_cast<double>(document_frequency[column]) + (smooth_idf ? 1.0 : 0.0);
+    idf[column] = std::log(n / df) + 1.0;
+  }
+  return idf;
+}
+
+void weight_row(const WordCounts& counts, const std::vector<int>& column_of_symbol,
+                const std::vector<double>& idf, bool sublinear_tf, float* row,
+                std::vector<std::pair<int, double>>& scratch) {
+  scratch.clear();
+  for (const auto& entry : counts) {
+    const int column = column_of_symbol[entry.first];
+    if (column >= 0) {
+      const double tf = sublinear_tf ? 1.0 + std::log(static_cast<double>(entry.second))
+                                     : static_cast<double>(entry.second);
+      scratch.emplace_back(column, tf * idf[column]);
+    }
+  }
+  std::sort(scratch.begin(), scratch.end());
+  double squares = 0.0;
+  for (const auto& weight : scratch) {
+    squares += weight.second * weight.second;
+  }
+  const double norm = squares > 0.0 ? std::sqrt(squares) : 1.0;
+  for (const auto& weight : scratch) {
+    row[weight.first] = static_cast<float>(weight.second / norm);
+  }
+}
+
+}  // namespace bow
@@ -0,0 +1,231 @@
+// thread_pool.cpp: Deques Chase–Lev sin candados y bucle de trabajo con robo entre hilos.
+#include "bow/thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+namespace {
+
+// Capacidad inicial de cada deque (potencia de 2); crece al doble cuando se llena.
+constexpr std::int64_t kInitialDequeCapacity = 64;
+
+}  // namespace
+
+namespace bow {
+
+SchedulerStats& SchedulerStats::operator+=(const SchedulerStats& other) {
+  tasks += other.tasks;
+  steals += other.steals;
+  failed_steals += other.failed_steals;
+  idle_ms += other.idle_ms;
+  return *this;
+}
+
+int resolve_thread_count(int requested) {
+  if (requested > 0) {
+    return requested;
+  }
+  const unsigned hardware = std::thread::hardware_concurrency();
+  return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+// Arreglo circular de punteros; las casillas son atómicas porque un ladrón puede leer una
+// casilla mientras el dueño la reescribe (el CAS sobre `top` descarta esa lectura).
+struct WorkStealingDeque::Ring {
+  explicit Ring(std::int64_t size)
+      : capacity(size), mask(size - 1), slots(new std::atomic<Task*>[size]) {}
+
+  Task* get(std::int64_t index) const {
+    return slots[index & mask].load(std::memory_order_relaxed);
+  }
+  void put(std::int64_t index, Task* task) {
+    slots[index & mask].store(task, std::memory_order_relaxed);
+  }
+
+  std::int64_t capacity;
+  std::int64_t mask;
+  std::unique_ptr<std::atomic<Task*>[]> slots;
+};
+
+WorkStealingDeque::WorkStealingDeque() {
+  rings_.push_back(std::make_unique<Ring>(kInitialDequeCapacity));
+  ring_.store(rings_.back().get(), std::memory_order_relaxed);
+}
+
+WorkStealingDeque::~WorkStealingDeque() {
+  // Solo quedan tareas si run() no llegó a ejecutarse; se liberan aquí.
+  while (Task* task = pop()) {
+    delete task;
+  }
+}
+
+WorkStealingDeque::Ring* WorkStealingDeque::grow(Ring* ring, std::int64_t bottom,
+                                                 std::int64_t top) {
+  auto bigger = std::make_unique<Ring>(ring->capacity * 2);
+  for (std::int64_t i = top; i < bottom; ++i) {
+    bigger->put(i, ring->get(i));
+  }
+  rings_.push_back(std::move(bigger));
+  Ring* current = rings_.back().get();
+  ring_.store(current, std::memory_order_release);
+  return current;
+}
+
+void WorkStealingDeque::push(Task* task) {
+  const std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  const std::int64_t top = top_.load(std::memory_order_acquire);
+  Ring* ring = ring_.load(std::memory_order_relaxed);
+  if (bottom - top > ring->capacity - 1) {
+    ring = grow(ring, bottom, top);
+  }
+  ring->put(bottom, task);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(bottom + 1, std::memory_order_relaxed);
+}
+
+Task* WorkStealingDeque::pop() {
+  const std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  Ring* ring = ring_.load(std::memory_order_relaxed);
+  bottom_.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t top = top_.load(std::memory_order_relaxed);
+
+  if (top > bottom) {  // Vacía: restauramos bottom.
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  Task* task = ring->get(bottom);
+  if (top == bottom) {
+    // Último elemento: competimos con los ladrones por él.
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      task = nullptr;
+    }
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return task;
+}
+
+Task* WorkStealingDeque::steal() {
+  std::int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+  if (top >= bottom) {
+    return nullptr;
+  }
+  Task* task = ring_.load(std::memory_order_acquire)->get(top);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return nullptr;  // Otro ladrón (o el dueño) se la llevó primero.
+  }
+  return task;
+}
+
+TaskScheduler::TaskScheduler(int num_threads) {
+  const int workers = std::max(1, num_threads);
+  deques_.reserve(workers);
+  for (int w = 0; w < workers; ++w) {
+    deques_.push_back(std::make_unique<WorkStealingDeque>());
+  }
+}
+
+TaskScheduler::~TaskScheduler() = default;
+
+void TaskScheduler::spawn(int worker, Task task) {
+  // pending_ sube antes de publicar la tarea para que nadie vea cero con trabajo encolado.
+  pending_.fetch_add(1, std::memory_order_relaxed);
+  deques_[worker]->push(new Task(std::move(task)));
+}
+
+void TaskScheduler::work(int worker, SchedulerStats& stats) {
+  using Clock = std::chrono::steady_clock;
+  const int workers = num_threads();
+  WorkStealingDeque& own = *deques_[worker];
+  bool idle = false;
+  Clock::time_point idle_since;
+
+  while (pending_.load(std::memory_order_acquire) > 0) {
+    Task* task = own.pop();
+    // Deque propia vacía: recorremos a los demás empezando por el vecino.
+    for (int offset = 1; task == nullptr && offset < workers; ++offset) {
+      task = deques_[(worker + offset) % workers]->steal();
+      if (task != nullptr) {
+        ++stats.steals;
+      } else {
+        ++stats.failed_steals;
+      }
+    }
+
+    if (task == nullptr) {
+      // Puede que otro trabajador aún esté generando subtareas: esperamos sin bloquear.
+      if (!idle) {
+        idle = true;
+        idle_since = Clock::now();
+      }
+      std::this_thread::yield();
+      continue;
+    }
+    if (idle) {
+      idle = false;
+      stats.idle_ms +=
+          std::chrono::duration<double, std::milli>(Clock::now() - idle_since).count();
+    }
+
+    (*task)(*this, worker);
+    delete task;
+    ++stats.tasks;
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+  if (idle) {
+    stats.idle_ms += std::chrono::duration<double, std::milli>(Clock::now() - idle_since).count();
+  }
+}
+
+void TaskScheduler::run() {
+  const int workers = num_threads();
+  std::vector<SchedulerStats> stats_by_worker(workers);
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (int w = 1; w < workers; ++w) {
+    threads.emplace_back([this, w, &stats_by_worker]() { work(w, stats_by_worker[w]); });
+  }
+  work(0, stats_by_worker[0]);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& stats : stats_by_worker) {
+    stats_ += stats;
+  }
+}
+
+void parallel_for_work_stealing(std::size_t count, int num_threads,
+                                const std::function<void(std::size_t index, int worker)>& task,
+                                SchedulerStats* stats) {
+  const int workers = std::max(1, std::min<int>(num_threads, static_cast<int>(count)));
+  if (workers <= 1) {
+    for (std::size_t index = 0; index < count; ++index) {
+      task(index, 0);
+    }
+    return;
+  }
+
+  TaskScheduler scheduler(workers);
+  for (int w = 0; w < workers; ++w) {
+    // Bloque contiguo por trabajador, empujado al revés: el dueño saca por abajo y recorre su
+    // bloque en orden ascendente, mientras los ladrones se llevan el final del bloque.
+    const std::size_t first = count * w / workers;
+    const std::size_t last = count * (w + 1) / workers;
+    for (std::size_t index = last; index > first; --index) {
+      scheduler.spawn(w, [&task, index](TaskScheduler&, int worker) { task(index - 1, worker); });
+    }
+  }
+  scheduler.run();
+  if (stats != nullptr) {
+    *stats += scheduler.stats();
+  }
+}
+
+}  // namespace bow
@@ -0,0 +1,240 @@
+// tokenizer.cpp: Decodificador UTF-8 con tablas de letras y plegado de mayúsculas latinas.
+#include "bow/tokenizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+// Primer y último code point cubiertos por la tabla latina (Latin-1 y Latin Extendido A/B).
+constexpr std::uint32_t kLatinFirst = 0x80;
+constexpr std::uint32_t kLatinLast = 0x24F;
+
+// Forma en minúsculas (plegado simple de Unicode) de un code point latino; 0 si es delimitador.
+// Solo se pliega a formas que no ocupan más bytes en UTF-8, así el texto normalizado nunca
+// crece (por eso, por ejemplo, U+023A queda igual en vez de ir a U+2C65).
+constexpr std::uint32_t fold_latin(std::uint32_t cp) {
+  const auto even_upper = [](std::uint32_t c) { return c % 2 == 0 ? c + 1 : c; };
+  const auto odd_upper = [](std::uint32_t c) { return c % 2 == 1 ? c + 1 : c; };
+  if (cp < 0xC0) {
+    // Controles, espacios y signos de Latin-1; solo ª, º y µ son letras.
+    if (cp == 0xAA || cp == 0xBA) {
+      return cp;
+    }
+    return cp == 0xB5 ? 0x3BC : 0;
+  }
+  if (cp == 0xD7 || cp == 0xF7) {
+    return 0;  // × y ÷
+  }
+  if (cp <= 0xDE) {
+    return cp + 0x20;
+  }
+  if (cp <= 0xFF) {
+    return cp;
+  }
+  if (cp == 0x130) {
+    return 'i';
+  }
+  if (cp == 0x131 || cp == 0x138 || cp == 0x149) {
+    return cp;
+  }
+  if (cp <= 0x137) {
+    return even_upper(cp);
+  }
+  if (cp <= 0x148) {
+    return odd_upper(cp);
+  }
+  if (cp <= 0x177) {
+    return even_upper(cp);
+  }
+  if (cp == 0x178) {
+    return 0xFF;
+  }
+  if (cp <= 0x17E) {
+    return odd_upper(cp);
+  }
+  if (cp == 0x17F) {
+    return 's';
+  }
+  // Latin Extendido B: dígrafos y tramos de pares regulares; el resto no tiene pareja en el
+  // mismo bloque.
+  if (cp >= 0x1C4 && cp <= 0x1CC) {
+    return 0x1C6 + (cp - 0x1C4) / 3 * 3;
+  }
+  if (cp == 0x1F1 || cp == 0x1F2) {
+    return 0x1F3;
+  }
+  if (cp >= 0x1CD && cp <= 0x1DC) {
+    return odd_upper(cp);
+  }
+  if ((cp >= 0x1DE && cp <= 0x1EF) || (cp >= 0x1F4 && cp <= 0x1F5) ||
+      (cp >= 0x1F8 && cp <= 0x21F) || (cp >= 0x222 && cp <= 0x233) ||
+      (cp >= 0x246 && cp <= 0x24F)) {
+    return even_upper(cp);
+  }
+  return cp;
+}
+
+constexpr std::array<std::uint16_t, kLatinLast - kLatinFirst + 1> make_latin_table() {
+  std::array<std::uint16_t, kLatinLast - kLatinFirst + 1> table{};
+  for (std::uint32_t cp = kLatinFirst; cp <= kLatinLast; ++cp) {
+    table[cp - kLatinFirst] = static_cast<std::uint16_t>(fold_latin(cp));
+  }
+  return table;
+}
+
+constexpr std::array<std::uint16_t, kLatinLast - kLatinFirst + 1> kLatinTable =
+    make_latin_table();
+
+// Bloques (ordenados, inclusivos) de puntuación, símbolos y espacios fuera de la tabla latina.
+// Cualquier otro code point se considera parte de un token y se conserva tal cual: letras de
+// otros alfabetos, marcas combinantes, dígitos no ASCII.
+constexpr std::pair<std::uint32_t, std::uint32_t> kDelimiterRanges[] = {
+    {0x037E, 0x037E},    // Signo de interrogación griego
+    {0x0387, 0x0387},    // Punto alto griego
+    {0x055A, 0x055F},    // Puntuación armenia
+    {0x0589, 0x058A},
+    {0x05BE, 0x05BE},    // Puntuación hebrea
+    {0x05C0, 0x05C0},
+    {0x05C3, 0x05C3},
+    {0x05C6, 0x05C6},
+    {0x05F3, 0x05F4},
+    {0x060C, 0x060D},    // Puntuación árabe
+    {0x061B, 0x061B},
+    {0x061E, 0x061F},
+    {0x066A, 0x066D},
+    {0x06D4, 0x06D4},
+    {0x0964, 0x0965},    // Danda devanagari
+    {0x2000, 0x206F},    // Puntuación general (espacios, guiones, comillas)
+    {0x20A0, 0x20CF},    // Monedas
+    {0x2190, 0x245F},    // Flechas, operadores y símbolos técnicos
+    {0x2500, 0x2BFF},    // Cajas, figuras, dingbats
+    {0x2E00, 0x2E7F},    // Puntuación suplementaria
+    {0x3000, 0x303F},    // Puntuación CJK
+    {0xFE10, 0xFE1F},    // Formas verticales
+    {0xFE30, 0xFE6F},    // Formas de compatibilidad CJK y variantes pequeñas
+    {0xFEFF, 0xFEFF},    // Marca de orden de bytes
+    {0xFF00, 0xFF0F},    // Puntuación de ancho completo
+    {0xFF1A, 0xFF20},
+    {0xFF3B, 0xFF40},
+    {0xFF5B, 0xFF65},
+    {0xFFF0, 0xFFFF},    // Especiales
+    {0x1F000, 0x1FAFF},  // Emoji y pictogramas
+    {0xE0000, 0xE007F},  // Etiquetas
+};
+
+bool is_delimiter(std::uint32_t cp) {
+  const auto* const end = std::end(kDelimiterRanges);
+  const auto* const range = std::upper_bound(
+      std::begin(kDelimiterRanges), end, cp,
+      [](std::uint32_t value, const auto& bounds) { return value < bounds.first; });
+  return range != std::begin(kDelimiterRanges) && cp <= (range - 1)->second;
+}
+
+// Forma en minúsculas de cualquier code point; 0 si es delimitador.
+std::uint32_t fold(std::uint32_t cp) {
+  if (cp <= kLatinLast) {
+    return kLatinTable[cp - kLatinFirst];
+  }
+  if (cp >= 0x1E00 && cp <= 0x1EFF) {
+    // Latin Extendido Adicional: pares regulares salvo ẞ (a ß) y las letras sin mayúscula.
+    if (cp == 0x1E9E) {
+      return 0xDF;
+    }
+    return cp <= 0x1E95 || cp >= 0x1EA0 ? (cp % 2 == 0 ? cp + 1 : cp) : cp;
+  }
+  return is_delimiter(cp) ? 0 : cp;
+}
+
+std::size_t encode(std::uint32_t cp, char* out) {
+  if (cp < 0x80) {
+    out[0] = static_cast<char>(cp);
+    return 1;
+  }
+  if (cp < 0x800) {
+    out[0] = static_cast<char>(0xC0 | (cp >> 6));
+    out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    out[0] = static_cast<char>(0xE0 | (cp >> 12));
+    out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 3;
+  }
+  out[0] = static_cast<char>(0xF0 | (cp >> 18));
+  out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+  out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+  out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+  return 4;
+}
+
+bool is_continuation(unsigned char byte) { return (byte & 0xC0) == 0x80; }
+
+}  // namespace
+
+namespace bow {
+
+bool parse_tokenizer_mode(const std::string& name, TokenizerMode& mode) {
+  if (name == "ascii") {
+    mode = TokenizerMode::kAscii;
+  } else if (name == "utf8") {
+    mode = TokenizerMode::kUtf8;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+namespace detail {
+
+std::size_t decode_multibyte(const unsigned char* data, std::size_t available, char* folded,
+                             std::size_t& folded_size) {
+  folded_size = 0;
+  const unsigned char lead = data[0];
+  std::size_t length = 0;
+  std::uint32_t cp = 0;
+  // Rango válido del segundo byte: excluye formas sobrelargas, sustitutos y > U+10FFFF.
+  unsigned char second_min = 0x80;
+  unsigned char second_max = 0xBF;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+    cp = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    cp = lead & 0x0F;
+    second_min = lead == 0xE0 ? 0xA0 : 0x80;
+    second_max = lead == 0xED ? 0x9F : 0xBF;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    cp = lead & 0x07;
+    second_min = lead == 0xF0 ? 0x90 : 0x80;
+    second_max = lead == 0xF4 ? 0x8F : 0xBF;
+  } else {
+    return 1;  // Continuación suelta o byte que nunca aparece en UTF-8.
+  }
+
+  for (std::size_t k = 1; k < length; ++k) {
+    if (k == available) {
+      return 0;  // Lo visto hasta aquí es válido; faltan bytes.
+    }
+    const unsigned char byte = data[k];
+    const bool valid = k == 1 ? byte >= second_min && byte <= second_max : is_continuation(byte);
+    if (!valid) {
+      return 1;
+    }
+    cp = (cp << 6) | (byte & 0x3F);
+  }
+
+  const std::uint32_t lower = fold(cp);
+  if (lower != 0) {
+    folded_size = encode(lower, folded);
+  }
+  return length;
+}
+
+}  // namespace detail
+
+}  // namespace bow
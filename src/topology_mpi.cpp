@@ -0,0 +1,23 @@
+// topology_mpi.cpp: Creación y liberación de los comunicadores por nodo y de líderes.
+#include "bow/topology.hpp"
+
+namespace bow {
+
+NodeTopology::NodeTopology() {
+  int world_rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL,
+                      &node_comm_);
+  MPI_Comm_rank(node_comm_, &node_rank_);
+  MPI_Comm_size(node_comm_, &node_size_);
+  MPI_Comm_split(MPI_COMM_WORLD, node_rank_ == 0 ? 0 : MPI_UNDEFINED, world_rank, &leader_comm_);
+}
+
+NodeTopology::~NodeTopology() {
+  if (leader_comm_ != MPI_COMM_NULL) {
+    MPI_Comm_free(&leader_comm_);
+  }
+  MPI_Comm_free(&node_comm_);
+}
+
+}  // namespace bow
@@ -0,0 +1,91 @@
+// trace.cpp: Registro de eventos y escritura del formato Chrome trace.
+#include "bow/trace.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// Escapa los caracteres que JSON no admite sin escapar dentro de un string.
+std::string json_escape(const std::string& text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char ch : text) {
+    if (ch == '"' || ch == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(ch);
+    } else if (static_cast<unsigned char>(ch) < 0x20) {
+      escaped.push_back(' ');
+    } else {
+      escaped.push_back(ch);
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+namespace bow {
+
+TraceRecorder::TraceRecorder(bool enabled) : enabled_(enabled) {}
+
+void TraceRecorder::begin(const std::string& name, const std::string& category) {
+  if (!enabled_) {
+    return;
+  }
+  open_.push_back(events_.size());
+  const double now = now_us();
+  events_.push_back({name, category, now, now});
+}
+
+void TraceRecorder::end() {
+  if (!enabled_ || open_.empty()) {
+    return;
+  }
+  events_[open_.back()].end_us = now_us();
+  open_.pop_back();
+}
+
+double TraceRecorder::now_us() {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+TraceScope::TraceScope(TraceRecorder& trace, const std::string& name, const std::string& category)
+    : trace_(trace) {
+  trace_.begin(name, category);
+}
+
+TraceScope::~TraceScope() { trace_.end(); }
+
+void write_chrome_trace(const std::string& path,
+                        const std::vector<std::vector<TraceEvent>>& events_by_rank,
+                        double origin_us) {
+  std::ofstream output(path);
+  if (!output.is_open()) {
+    std::cerr << "No se pudo abrir el archivo de trace: " << path << std::endl;
+    return;
+  }
+
+  output << std::fixed << std::setprecision(3);
+  output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (std::size_t rank = 0; rank < events_by_rank.size(); ++rank) {
+    // Metadatos para que cada rank aparezca como un proceso con nombre propio.
+    output << (first ? "" : ",") << "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank
+           << ",\"args\":{\"name\":\"rank " << rank << "\"}}";
+    first = false;
+    for (const auto& event : events_by_rank[rank]) {
+      output << ",\n{\"name\":\"" << json_escape(event.name) << "\",\"cat\":\""
+             << json_escape(event.category) << "\",\"ph\":\"X\",\"pid\":" << rank
+             << ",\"tid\":0,\"ts\":" << event.begin_us - origin_us
+             << ",\"dur\":" << event.end_us - event.begin_us << "}";
+    }
+  }
+  output << "\n]}\n";
+}
+
+}  // namespace bow
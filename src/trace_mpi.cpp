@@ -0,0 +1,133 @@
+// trace_mpi.cpp: Alineación de relojes entre ranks y combinación de los traces en rank 0.
+#include "bow/trace.hpp"
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kClockSyncTag = 7301;
+constexpr int kClockSyncRounds = 8;
+
+// Desfase (microsegundos) que hay que sumar al reloj local para llevarlo al de rank 0.
+// Algoritmo de Cristian: se usa el ping-pong con menor ida y vuelta.
+double estimate_clock_offset_us(int world_rank, int world_size) {
+  double offset = 0.0;
+  if (world_rank == 0) {
+    for (int peer = 1; peer < world_size; ++peer) {
+      for (int round = 0; round < kClockSyncRounds; ++round) {
+        double ping = 0.0;
+        MPI_Recv(&ping, 1, MPI_DOUBLE, peer, kClockSyncTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        const double reference = bow::TraceRecorder::now_us();
+        MPI_Send(&reference, 1, MPI_DOUBLE, peer, kClockSyncTag, MPI_COMM_WORLD);
+      }
+    }
+    return offset;
+  }
+
+  double best_round_trip = std::numeric_limits<double>::max();
+  for (int round = 0; round < kClockSyncRounds; ++round) {
+    const double sent = bow::TraceRecorder::now_us();
+    double reference = 0.0;
+    MPI_Send(&sent, 1, MPI_DOUBLE, 0, kClockSyncTag, MPI_COMM_WORLD);
+    MPI_Recv(&reference, 1, MPI_DOUBLE, 0, kClockSyncTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    const double received = bow::TraceRecorder::now_us();
+    const double round_trip = received - sent;
+    if (round_trip < best_round_trip) {
+      best_round_trip = round_trip;
+      offset = reference - (sent + received) / 2.0;  // Suponemos latencia simétrica.
+    }
+  }
+  return offset;
+}
+
+// Serializa los eventos (ya alineados) como líneas "nombre\tcategoría\tinicio\tfin".
+std::string serialize_events(const std::vector<bow::TraceEvent>& events, double offset_us) {
+  std::ostringstream serialized;
+  serialized.precision(17);
+  for (const auto& event : events) {
+    serialized << event.name << '\t' << event.category << '\t' << event.begin_us + offset_us
+               << '\t' << event.end_us + offset_us << '\n';
+  }
+  return serialized.str();
+}
+
+// Operación inversa de serialize_events.
+std::vector<bow::TraceEvent> parse_events(const std::string& data) {
+  std::vector<bow::TraceEvent> events;
+  std::istringstream input(data);
+  std::string line;
+  while (std::getline(input, line)) {
+    std::istringstream fields(line);
+    bow::TraceEvent event;
+    if (std::getline(fields, event.name, '\t') && std::getline(fields, event.category, '\t') &&
+        fields >> event.begin_us >> event.end_us) {
+      events.push_back(std::move(event));
+    }
+  }
+  return events;
+}
+
+}  // namespace
+
+namespace bow {
+
+void write_merged_trace_mpi(const TraceRecorder& trace, const std::string& path) {
+  int world_rank = 0;
+  int world_size = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+  const double offset_us = estimate_clock_offset_us(world_rank, world_size);
+  const std::string local_serialized = serialize_events(trace.events(), offset_us);
+  const int local_bytes = static_cast<int>(local_serialized.size());
+
+  std::vector<int> byte_counts;
+  if (world_rank == 0) {
+    byte_counts.resize(world_size);
+  }
+  MPI_Gather(&local_bytes, 1, MPI_INT, world_rank == 0 ? byte_counts.data() : nullptr, 1, MPI_INT,
+             0, MPI_COMM_WORLD);
+
+  std::vector<int> displs;
+  std::vector<char> buffer;
+  if (world_rank == 0) {
+    displs.resize(world_size);
+    int total = 0;
+    for (int i = 0; i < world_size; ++i) {
+      displs[i] = total;
+      total += byte_counts[i];
+    }
+    buffer.resize(total);
+  }
+  MPI_Gatherv(local_serialized.data(), local_bytes, MPI_CHAR,
+              world_rank == 0 ? buffer.data() : nullptr,
+              world_rank == 0 ? byte_counts.data() : nullptr,
+              world_rank == 0 ? displs.data() : nullptr, MPI_CHAR, 0, MPI_COMM_WORLD);
+
+  if (world_rank != 0) {
+    return;
+  }
+
+  std::vector<std::vector<TraceEvent>> events_by_rank(world_size);
+  double origin_us = std::numeric_limits<double>::max();
+  for (int i = 0; i < world_size; ++i) {
+    events_by_rank[i] =
+        parse_events(std::string(buffer.begin() + displs[i],
+                                 buffer.begin() + displs[i] + byte_counts[i]));
+    for (const auto& event : events_by_rank[i]) {
+      origin_us = std::min(origin_us, event.begin_us);
+    }
+  }
+  if (origin_us == std::numeric_limits<double>::max()) {
+    origin_us = 0.0;
+  }
+  write_chrome_trace(path, events_by_rank, origin_us);
+}
+
+}  // namespace bow
@@ -0,0 +1,101 @@
+// word_counts.cpp: Cierre de conteos por documento y suma de conteos parciales.
+#include "bow/word_counts.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+namespace bow {
+
+void merge_counts(WordCounts& counts, const WordCounts& other) {
+  WordCounts merged;
+  merged.reserve(counts.size() + other.size());
+  auto left = counts.begin();
+  auto right = other.begin();
+  while (left != counts.end() && right != other.end()) {
+    if (left->first < right->first) {
+      merged.push_back(*left++);
+    } else if (right->first < left->first) {
+      merged.push_back(*right++);
+    } else {
+      merged.emplace_back(left->first, left->second + right->second);
+      ++left;
+      ++right;
+    }
+  }
+  merged.insert(merged.end(), left, counts.end());
+  merged.insert(merged.end(), right, other.end());
+  counts = std::move(merged);
+}
+
+void WordCounter::remember_stem(SymbolId id, std::string_view token) {
+  if (id >= stem_of_.size()) {
+    stem_of_.resize(std::max<std::size_t>(id + 1, stem_of_.size() * 2), kNoSymbol);
+  }
+  const std::string stem = stem_word(token, stemmer_);
+  // El símbolo de la raíz puede quedar fuera de stem_of_; no importa, solo se indexa por
+  // símbolos de palabras vistas.
+  stem_of_[id] = stem == token ? id : cache_.intern(stem);
+}
+
+void WordCounter::add_to_ngrams(SymbolId id, std::string_view token, std::size_t trailing) {
+  if (trailing == 0 && ngrams_.min == 1) {
+    count(id, token);
+  }
+  SymbolId term = id;
+  if (stemmer_ != StemmerLanguage::kNone) {
+    if (!has_stem(id)) {
+      remember_stem(id, token);
+    }
+    term = stem_of_[id];
+  }
+  if (window_size_ == ngrams_.max) {
+    std::copy(window_.begin() + 1, window_.begin() + window_size_, window_.begin());
+    --window_size_;
+  }
+  window_[window_size_++] = term;
+
+  NgramKey key;
+  for (std::size_t n = std::max<std::size_t>({2, ngrams_.min, trailing + 1});
+       n <= window_size_; ++n) {
+    key.fill(kNoSymbol);
+    std::copy(window_.begin() + (window_size_ - n), window_.begin() + window_size_, key.begin());
+    count_symbol(cache_.intern_ngram(key));
+  }
+}
+
+void WordCounter::add_char_ngrams(std::string_view token) {
+  chars_.extract(token, [this](std::string_view ngram, std::uint64_t hash) {
+    count_symbol(cache_.intern(ngram, hash));
+  });
+}
+
+WordCounts WordCounter::finish() {
+  window_size_ = 0;
+  trailing_ = 0;
+  for (auto& entry : current_) {
+    position_of_[entry.first] = kAbsent;
+    // Los n-gramas ya se formaron con raíces: solo las palabras sueltas tienen stem_of_.
+    if (stemmer_ != StemmerLanguage::kNone && has_stem(entry.first)) {
+      entry.first = stem_of_[entry.first];
+    }
+  }
+  std::sort(current_.begin(), current_.end());
+  if (stemmer_ != StemmerLanguage::kNone) {
+    // Palabras con la misma raíz quedaron juntas: se suman en una sola entrada.
+    auto out = current_.begin();
+    for (auto entry = current_.begin(); entry != current_.end(); ++entry) {
+      if (out != current_.begin() && std::prev(out)->first == entry->first) {
+        std::prev(out)->second += entry->second;
+      } else {
+        *out++ = *entry;
+      }
+    }
+    current_.erase(out, current_.end());
+  }
+  WordCounts counts = std::move(current_);
+  current_.clear();
+  return counts;
+}
+
+}  // namespace bow